@@ -0,0 +1,151 @@
+// Задержка запросов во время пополнения индекса: SearchServer под общим
+// мьютексом против ConcurrentSearchServer со снимками.
+// Сборка из каталога search-server:
+//   g++ -std=c++17 -O2 -I. benchmark/concurrent_ingest_benchmark.cpp concurrent_search_server.cpp
+//       search_server.cpp document.cpp document_bitmap.cpp relevance_accumulator.cpp query.cpp
+//       string_processing.cpp stop_word_table.cpp compressed_postings.cpp mapped_search_server.cpp
+//       search_trace.cpp -ltbb -pthread
+
+#include "concurrent_search_server.h"
+#include "search_server.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+namespace {
+
+const int VOCABULARY_SIZE = 5000;
+const int WORDS_PER_DOCUMENT = 50;
+const int PRELOADED_DOCUMENTS = 10000;
+const int INGESTED_DOCUMENTS = 10000;
+const int PUBLISH_EVERY = 100;
+const int READER_THREADS = 4;
+
+string GenerateText(mt19937& generator, int word_count) {
+    uniform_int_distribution<int> word_distribution(0, VOCABULARY_SIZE - 1);
+    string text;
+    for (int i = 0; i < word_count; ++i) {
+        text += "w"s + to_string(word_distribution(generator)) + " "s;
+    }
+    return text;
+}
+
+vector<string> GenerateTexts(uint32_t seed, int count, int word_count) {
+    mt19937 generator(seed);
+    vector<string> texts;
+    texts.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        texts.push_back(GenerateText(generator, word_count));
+    }
+    return texts;
+}
+
+struct BenchmarkResult {
+    vector<int64_t> latencies_ns;
+    double ingest_seconds = 0.0;
+};
+
+// Читатели гоняют запросы, пока писатель добавляет документы
+template <typename Query, typename Ingest>
+BenchmarkResult Run(const vector<string>& queries, Query query, Ingest ingest) {
+    atomic<bool> ingesting = true;
+    vector<vector<int64_t>> latencies(READER_THREADS);
+    vector<thread> readers;
+    for (int t = 0; t < READER_THREADS; ++t) {
+        readers.emplace_back([&, t] {
+            size_t i = t;
+            while (ingesting.load(memory_order_relaxed)) {
+                const auto start = steady_clock::now();
+                query(queries[i++ % queries.size()]);
+                latencies[t].push_back(duration_cast<nanoseconds>(steady_clock::now() - start).count());
+            }
+        });
+    }
+
+    BenchmarkResult result;
+    const auto start = steady_clock::now();
+    ingest();
+    result.ingest_seconds = duration<double>(steady_clock::now() - start).count();
+    ingesting = false;
+    for (thread& reader : readers) {
+        reader.join();
+    }
+    for (const auto& thread_latencies : latencies) {
+        result.latencies_ns.insert(result.latencies_ns.end(), thread_latencies.begin(), thread_latencies.end());
+    }
+    return result;
+}
+
+void Report(const string& name, BenchmarkResult result) {
+    auto& latencies = result.latencies_ns;
+    sort(latencies.begin(), latencies.end());
+    const auto percentile = [&latencies](double p) {
+        return latencies.empty() ? 0 : latencies[static_cast<size_t>(p * (latencies.size() - 1))];
+    };
+    cout << name << ": queries = "s << latencies.size()
+         << ", p50 = "s << percentile(0.5) / 1000 << " us"s
+         << ", p99 = "s << percentile(0.99) / 1000 << " us"s
+         << ", max = "s << percentile(1.0) / 1000 << " us"s
+         << ", ingest = "s << static_cast<int>(INGESTED_DOCUMENTS / result.ingest_seconds) << " docs/s"s << endl;
+}
+
+} // namespace
+
+int main() {
+    const vector<string> preloaded = GenerateTexts(1, PRELOADED_DOCUMENTS, WORDS_PER_DOCUMENT);
+    const vector<string> ingested = GenerateTexts(2, INGESTED_DOCUMENTS, WORDS_PER_DOCUMENT);
+    const vector<string> queries = GenerateTexts(3, 1000, 4);
+    const vector<int> ratings = {1, 2, 3};
+
+    {
+        SearchServer search_server("w0 w1 w2"s);
+        for (int id = 0; id < PRELOADED_DOCUMENTS; ++id) {
+            search_server.AddDocument(id, preloaded[id], DocumentStatus::ACTUAL, ratings);
+        }
+        mutex server_mutex;
+        Report("global mutex"s, Run(queries,
+            [&](const string& raw_query) {
+                lock_guard guard(server_mutex);
+                return search_server.FindTopDocuments(raw_query);
+            },
+            [&] {
+                for (int i = 0; i < INGESTED_DOCUMENTS; ++i) {
+                    lock_guard guard(server_mutex);
+                    search_server.AddDocument(PRELOADED_DOCUMENTS + i, ingested[i], DocumentStatus::ACTUAL, ratings);
+                }
+            }));
+    }
+
+    {
+        ConcurrentSearchServer search_server("w0 w1 w2"s);
+        for (int id = 0; id < PRELOADED_DOCUMENTS; ++id) {
+            search_server.AddDocument(id, preloaded[id], DocumentStatus::ACTUAL, ratings);
+        }
+        search_server.Publish();
+        Report("snapshots"s, Run(queries,
+            [&](const string& raw_query) {
+                return search_server.FindTopDocuments(raw_query);
+            },
+            [&] {
+                for (int i = 0; i < INGESTED_DOCUMENTS; ++i) {
+                    search_server.AddDocument(PRELOADED_DOCUMENTS + i, ingested[i], DocumentStatus::ACTUAL, ratings);
+                    if ((i + 1) % PUBLISH_EVERY == 0) {
+                        search_server.Publish();
+                    }
+                }
+                search_server.Publish();
+            }));
+    }
+    return 0;
+}
@@ -0,0 +1,300 @@
+// Пропускная способность индексации и задержки поиска на синтетическом корпусе.
+// Слова документов и запросов выбираются по закону Ципфа, весь корпус задаётся
+// параметрами и зерном генератора, поэтому прогоны с одинаковыми параметрами
+// сравнимы между собой. Параметры передаются как --имя=значение, см. Config.
+// Сборка из каталога search-server:
+//   g++ -std=c++17 -O2 -I. benchmark/search_benchmark.cpp search_server.cpp document.cpp document_bitmap.cpp
+//       relevance_accumulator.cpp query.cpp string_processing.cpp search_trace.cpp
+//       stop_word_table.cpp compressed_postings.cpp mapped_search_server.cpp -ltbb -pthread
+
+#include "search_server.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <execution>
+#include <iostream>
+#include <new>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+namespace {
+
+atomic<uint64_t> allocation_count{0};
+
+} // namespace
+
+// Считаем все выделения памяти в программе, чтобы получить число выделений на запрос.
+// Замены не встраиваются: иначе GCC видит malloc и free на месте new и delete
+// и ложно предупреждает о несовпадающей паре (-Wmismatched-new-delete)
+#if defined(__GNUC__)
+#define BENCHMARK_NOINLINE __attribute__((noinline))
+#else
+#define BENCHMARK_NOINLINE
+#endif
+
+BENCHMARK_NOINLINE void* operator new(size_t size) {
+    allocation_count.fetch_add(1, memory_order_relaxed);
+    if (void* pointer = malloc(size == 0 ? 1 : size)) {
+        return pointer;
+    }
+    throw bad_alloc();
+}
+
+BENCHMARK_NOINLINE void operator delete(void* pointer) noexcept {
+    free(pointer);
+}
+
+// Размер не нужен: память освобождает вариант без размера
+void operator delete(void* pointer, size_t) noexcept {
+    ::operator delete(pointer);
+}
+
+namespace {
+
+struct Config {
+    uint32_t seed = 42;
+    int document_count = 100000;
+    int vocabulary_size = 50000;
+    int document_length = 60;
+    int stop_word_count = 20;
+    int query_count = 10000;
+    int query_length = 3;
+    double minus_word_ratio = 0.1;
+    double zipf_exponent = 1.0;
+};
+
+Config ParseConfig(int argc, char* argv[]) {
+    Config config;
+    for (int i = 1; i < argc; ++i) {
+        const string_view argument = argv[i];
+        const size_t equals = argument.find('=');
+        if (argument.substr(0, 2) != "--"sv || equals == string_view::npos) {
+            throw invalid_argument("Expected --name=value, got "s + string(argument));
+        }
+        const string_view name = argument.substr(2, equals - 2);
+        const string value(argument.substr(equals + 1));
+        if (name == "seed"sv) {
+            config.seed = static_cast<uint32_t>(stoul(value));
+        } else if (name == "documents"sv) {
+            config.document_count = stoi(value);
+        } else if (name == "vocabulary"sv) {
+            config.vocabulary_size = stoi(value);
+        } else if (name == "document-length"sv) {
+            config.document_length = stoi(value);
+        } else if (name == "stop-words"sv) {
+            config.stop_word_count = stoi(value);
+        } else if (name == "queries"sv) {
+            config.query_count = stoi(value);
+        } else if (name == "query-length"sv) {
+            config.query_length = stoi(value);
+        } else if (name == "minus-ratio"sv) {
+            config.minus_word_ratio = stod(value);
+        } else if (name == "zipf"sv) {
+            config.zipf_exponent = stod(value);
+        } else {
+            throw invalid_argument("Unknown option "s + string(name));
+        }
+    }
+    if (config.document_count <= 0 || config.vocabulary_size <= 0 || config.document_length <= 0
+        || config.query_count <= 0 || config.query_length <= 0) {
+        throw invalid_argument("Counts and lengths must be positive"s);
+    }
+    return config;
+}
+
+// Стандартные распределения реализованы в библиотеках по-разному, поэтому
+// случайные числа выводятся прямо из mt19937, который везде одинаков
+double GenerateUniform(mt19937& generator) {
+    return generator() / 4294967296.0;
+}
+
+// Номер слова от 0 до vocabulary_size - 1; слово с номером k встречается
+// с вероятностью, пропорциональной 1 / (k + 1)^exponent
+class ZipfDistribution {
+public:
+    ZipfDistribution(int vocabulary_size, double exponent)
+        : cumulative_weights_(vocabulary_size) {
+        double total = 0.0;
+        for (int rank = 0; rank < vocabulary_size; ++rank) {
+            total += 1.0 / pow(rank + 1, exponent);
+            cumulative_weights_[rank] = total;
+        }
+        for (double& weight : cumulative_weights_) {
+            weight /= total;
+        }
+    }
+
+    int operator()(mt19937& generator) const {
+        const double u = GenerateUniform(generator);
+        const auto it = upper_bound(cumulative_weights_.begin(), cumulative_weights_.end(), u);
+        return static_cast<int>(min(it - cumulative_weights_.begin(),
+                                    static_cast<ptrdiff_t>(cumulative_weights_.size() - 1)));
+    }
+
+private:
+    vector<double> cumulative_weights_;
+};
+
+string MakeWord(int rank) {
+    return "w"s + to_string(rank);
+}
+
+// Самые частые слова словаря служат стоп-словами
+string MakeStopWords(const Config& config) {
+    string stop_words;
+    for (int rank = 0; rank < config.stop_word_count; ++rank) {
+        stop_words += MakeWord(rank) + " "s;
+    }
+    return stop_words;
+}
+
+vector<string> GenerateDocuments(const Config& config, const ZipfDistribution& zipf, mt19937& generator) {
+    vector<string> documents;
+    documents.reserve(config.document_count);
+    for (int i = 0; i < config.document_count; ++i) {
+        string text;
+        for (int j = 0; j < config.document_length; ++j) {
+            text += MakeWord(zipf(generator)) + " "s;
+        }
+        documents.push_back(move(text));
+    }
+    return documents;
+}
+
+vector<string> GenerateQueries(const Config& config, const ZipfDistribution& zipf, mt19937& generator) {
+    vector<string> queries;
+    queries.reserve(config.query_count);
+    for (int i = 0; i < config.query_count; ++i) {
+        string query;
+        for (int j = 0; j < config.query_length; ++j) {
+            if (GenerateUniform(generator) < config.minus_word_ratio) {
+                query += "-"s;
+            }
+            query += MakeWord(zipf(generator)) + " "s;
+        }
+        queries.push_back(move(query));
+    }
+    return queries;
+}
+
+struct Measurement {
+    vector<int64_t> latencies_ns;
+    uint64_t allocations = 0;
+};
+
+template <typename Operation>
+Measurement Measure(size_t count, Operation operation) {
+    Measurement measurement;
+    measurement.latencies_ns.reserve(count);
+    const uint64_t allocations_before = allocation_count.load(memory_order_relaxed);
+    for (size_t i = 0; i < count; ++i) {
+        const auto start = steady_clock::now();
+        operation(i);
+        measurement.latencies_ns.push_back(duration_cast<nanoseconds>(steady_clock::now() - start).count());
+    }
+    // Вектор задержек заранее зарезервирован и в счёт не попадает
+    measurement.allocations = allocation_count.load(memory_order_relaxed) - allocations_before;
+    return measurement;
+}
+
+void Report(const string& name, Measurement measurement) {
+    auto& latencies = measurement.latencies_ns;
+    sort(latencies.begin(), latencies.end());
+    const auto percentile = [&latencies](double p) {
+        return latencies.empty() ? 0 : latencies[static_cast<size_t>(p * (latencies.size() - 1))];
+    };
+    const double count = max<size_t>(latencies.size(), 1);
+    cout << name << ": calls = "s << latencies.size()
+         << ", mean = "s << static_cast<int64_t>(accumulate(latencies.begin(), latencies.end(), 0.0) / count) << " ns"s
+         << ", p50 = "s << percentile(0.5) << " ns"s
+         << ", p90 = "s << percentile(0.9) << " ns"s
+         << ", p99 = "s << percentile(0.99) << " ns"s
+         << ", allocations = "s << measurement.allocations / count << " per call"s << endl;
+}
+
+template <typename Ingest>
+void ReportIngest(const string& name, int document_count, Ingest ingest) {
+    const uint64_t allocations_before = allocation_count.load(memory_order_relaxed);
+    const auto start = steady_clock::now();
+    ingest();
+    const double seconds = duration<double>(steady_clock::now() - start).count();
+    const uint64_t allocations = allocation_count.load(memory_order_relaxed) - allocations_before;
+    cout << name << ": "s << static_cast<int64_t>(document_count / seconds) << " docs/s"s
+         << ", allocations = "s << allocations / max(document_count, 1) << " per document"s << endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Config config;
+    try {
+        config = ParseConfig(argc, argv);
+    } catch (const exception& e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+    cout << "seed = "s << config.seed << ", documents = "s << config.document_count
+         << ", vocabulary = "s << config.vocabulary_size << ", document length = "s << config.document_length
+         << ", stop words = "s << config.stop_word_count << ", queries = "s << config.query_count
+         << ", query length = "s << config.query_length << ", minus ratio = "s << config.minus_word_ratio
+         << ", zipf = "s << config.zipf_exponent << endl;
+
+    mt19937 generator(config.seed);
+    const ZipfDistribution zipf(config.vocabulary_size, config.zipf_exponent);
+    const string stop_words = MakeStopWords(config);
+    const vector<string> documents = GenerateDocuments(config, zipf, generator);
+    const vector<string> queries = GenerateQueries(config, zipf, generator);
+    const vector<int> ratings = {1, 2, 3};
+
+    SearchServer search_server(stop_words);
+    ReportIngest("AddDocument"s, config.document_count, [&] {
+        for (int id = 0; id < config.document_count; ++id) {
+            search_server.AddDocument(id, documents[id], DocumentStatus::ACTUAL, ratings);
+        }
+    });
+    {
+        vector<NewDocument> new_documents;
+        new_documents.reserve(documents.size());
+        for (int id = 0; id < config.document_count; ++id) {
+            new_documents.push_back({id, documents[id], DocumentStatus::ACTUAL, ratings});
+        }
+        SearchServer bulk_server(stop_words);
+        ReportIngest("AddDocuments par"s, config.document_count, [&] {
+            bulk_server.AddDocuments(execution::par, new_documents);
+        });
+    }
+
+    // Первый проход прогревает кэши IDF и аккумулятор релевантности
+    for (const string& query : queries) {
+        search_server.FindTopDocuments(query);
+    }
+    Report("FindTopDocuments seq"s, Measure(queries.size(), [&](size_t i) {
+        search_server.FindTopDocuments(queries[i]);
+    }));
+    Report("FindTopDocuments par"s, Measure(queries.size(), [&](size_t i) {
+        search_server.FindTopDocuments(execution::par, queries[i]);
+    }));
+    Report("FindTopDocuments predicate"s, Measure(queries.size(), [&](size_t i) {
+        search_server.FindTopDocuments(queries[i], [](int document_id, DocumentStatus, int) {
+            return document_id % 2 == 0;
+        });
+    }));
+    Report("MatchDocument seq"s, Measure(queries.size(), [&](size_t i) {
+        search_server.MatchDocument(queries[i], static_cast<int>(i % config.document_count));
+    }));
+    Report("MatchDocument par"s, Measure(queries.size(), [&](size_t i) {
+        search_server.MatchDocument(execution::par, queries[i], static_cast<int>(i % config.document_count));
+    }));
+    return 0;
+}
@@ -0,0 +1,195 @@
+#include "compressed_postings.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace compressed_postings {
+
+namespace {
+
+const size_t BLOCK_HEADER_SIZE = 3;
+
+void ThrowCorrupted() {
+    throw std::runtime_error("Compressed posting stream is corrupted");
+}
+
+uint32_t GetBitWidth(uint32_t value) {
+    uint32_t bit_width = 0;
+    while (value != 0) {
+        ++bit_width;
+        value >>= 1;
+    }
+    return bit_width;
+}
+
+size_t GetPackedSize(size_t count, uint32_t bit_width) {
+    // Лишнее слово в конце позволяет распаковке всегда читать по 64 бита
+    return (count * bit_width + 31) / 32 + 1;
+}
+
+void PackBits(const uint32_t* values, size_t count, uint32_t bit_width, std::vector<uint32_t>& output) {
+    const size_t packed_start = output.size();
+    output.resize(packed_start + GetPackedSize(count, bit_width), 0);
+    for (size_t i = 0; i < count; ++i) {
+        const size_t bit = i * bit_width;
+        const uint64_t value = static_cast<uint64_t>(values[i]) << (bit % 32);
+        output[packed_start + bit / 32] |= static_cast<uint32_t>(value);
+        if (bit % 32 + bit_width > 32) {
+            output[packed_start + bit / 32 + 1] |= static_cast<uint32_t>(value >> 32);
+        }
+    }
+}
+
+} // namespace
+
+void Encode(const std::vector<std::pair<uint32_t, uint32_t>>& postings, std::vector<uint32_t>& output) {
+    const size_t start = output.size();
+    const size_t block_count = (postings.size() + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    output.push_back(static_cast<uint32_t>(block_count));
+    const size_t headers = output.size();
+    output.resize(headers + block_count * BLOCK_HEADER_SIZE);
+
+    uint32_t previous_document_index = 0;
+    for (size_t block = 0; block < block_count; ++block) {
+        const size_t first = block * BLOCK_SIZE;
+        const size_t count = std::min(BLOCK_SIZE, postings.size() - first);
+
+        uint32_t deltas[BLOCK_SIZE];
+        uint32_t occurrence_counts[BLOCK_SIZE];
+        uint32_t max_delta = 0;
+        uint32_t max_occurrence_count = 0;
+        for (size_t i = 0; i < count; ++i) {
+            deltas[i] = postings[first + i].first - previous_document_index;
+            previous_document_index = postings[first + i].first;
+            max_delta = std::max(max_delta, deltas[i]);
+            occurrence_counts[i] = postings[first + i].second;
+            max_occurrence_count = std::max(max_occurrence_count, occurrence_counts[i]);
+        }
+        const uint32_t bit_width = GetBitWidth(max_delta);
+        const uint32_t count_bit_width = GetBitWidth(max_occurrence_count);
+
+        uint32_t* header = &output[headers + block * BLOCK_HEADER_SIZE];
+        header[0] = previous_document_index;
+        header[1] = static_cast<uint32_t>(output.size() - start);
+        header[2] = bit_width | count_bit_width << 8 | static_cast<uint32_t>(count) << 16;
+
+        PackBits(deltas, count, bit_width, output);
+        PackBits(occurrence_counts, count, count_bit_width, output);
+    }
+}
+
+void UnpackBits(const uint32_t* packed, size_t count, uint32_t bit_width, uint32_t* output) {
+    if (bit_width == 0) {
+        std::fill(output, output + count, 0);
+        return;
+    }
+    const uint64_t mask = (uint64_t{1} << bit_width) - 1;
+    for (size_t i = 0; i < count; ++i) {
+        const size_t bit = i * bit_width;
+        const uint64_t window = packed[bit / 32] | static_cast<uint64_t>(packed[bit / 32 + 1]) << 32;
+        output[i] = static_cast<uint32_t>((window >> (bit % 32)) & mask);
+    }
+}
+
+Cursor::Cursor(const uint32_t* data, size_t available, uint64_t document_count)
+    : data_(data)
+    , available_(available)
+    , document_count_(document_count)
+    , block_count_(available == 0 ? 0 : data[0]) {
+    // Заголовки блоков должны уместиться целиком: Seek ищет по ним, не распаковывая блоки
+    if (available == 0 || block_count_ > (available - 1) / BLOCK_HEADER_SIZE) {
+        ThrowCorrupted();
+    }
+    if (block_count_ > 0) {
+        LoadBlock(0);
+    }
+}
+
+bool Cursor::IsEnd() const {
+    return block_ >= block_count_;
+}
+
+uint32_t Cursor::GetDocumentIndex() const {
+    return document_indexes_[position_];
+}
+
+uint32_t Cursor::GetOccurrenceCount() const {
+    return occurrence_counts_[position_];
+}
+
+void Cursor::Next() {
+    if (++position_ == block_size_) {
+        if (++block_ < block_count_) {
+            LoadBlock(block_);
+        }
+    }
+}
+
+void Cursor::Seek(uint32_t document_index) {
+    if (IsEnd()) {
+        return;
+    }
+    if (GetBlockHeader(block_)[0] < document_index) {
+        // Первый блок, в котором последний документ не меньше искомого
+        size_t left = block_ + 1;
+        size_t right = block_count_;
+        while (left < right) {
+            const size_t middle = left + (right - left) / 2;
+            if (GetBlockHeader(middle)[0] < document_index) {
+                left = middle + 1;
+            } else {
+                right = middle;
+            }
+        }
+        block_ = left;
+        if (IsEnd()) {
+            return;
+        }
+        LoadBlock(block_);
+    }
+    position_ = std::lower_bound(document_indexes_ + position_, document_indexes_ + block_size_, document_index)
+        - document_indexes_;
+}
+
+const uint32_t* Cursor::GetBlockHeader(size_t block) const {
+    return data_ + 1 + block * BLOCK_HEADER_SIZE;
+}
+
+void Cursor::LoadBlock(size_t block) {
+    const uint32_t* header = GetBlockHeader(block);
+    const uint32_t bit_width = header[2] & 0xFF;
+    const uint32_t count_bit_width = (header[2] >> 8) & 0xFF;
+    const size_t data_offset = header[1];
+    block_size_ = header[2] >> 16;
+    position_ = 0;
+    if (block_size_ == 0 || block_size_ > BLOCK_SIZE || bit_width > 32 || count_bit_width > 32
+        || data_offset < 1 + block_count_ * BLOCK_HEADER_SIZE || data_offset > available_
+        || GetPackedSize(block_size_, bit_width) + GetPackedSize(block_size_, count_bit_width)
+            > available_ - data_offset) {
+        ThrowCorrupted();
+    }
+
+    const uint32_t* packed = data_ + data_offset;
+    UnpackBits(packed, block_size_, bit_width, document_indexes_);
+    // Разности складываются в 64 бита, поэтому переполнение не спрячет выход за document_count_
+    uint64_t document_index = block == 0 ? 0 : GetBlockHeader(block - 1)[0];
+    for (size_t i = 0; i < block_size_; ++i) {
+        // Повтор номера допустим только для самого первого постинга с номером 0
+        if (document_indexes_[i] == 0 && (block != 0 || i != 0)) {
+            ThrowCorrupted();
+        }
+        document_index += document_indexes_[i];
+        document_indexes_[i] = static_cast<uint32_t>(document_index);
+    }
+    if (document_index >= document_count_ || document_index != header[0]) {
+        ThrowCorrupted();
+    }
+
+    UnpackBits(packed + GetPackedSize(block_size_, bit_width), block_size_, count_bit_width, occurrence_counts_);
+}
+
+} // namespace compressed_postings
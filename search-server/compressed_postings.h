@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Сжатый список постингов. Постинги разбиты на блоки по BLOCK_SIZE; в блоке
+// хранятся разности соседних номеров документов и числа вхождений слова в
+// документ, каждые упакованы в одинаковое для блока число бит. Частоту слова
+// читатель получает делением на число слов документа, без потери точности.
+// Перед блоками лежат их заголовки с последним номером документа в блоке:
+// по ним Seek находит нужный блок, не распаковывая предыдущие.
+//
+// Поток uint32 одного слова:
+//   block_count
+//   block_count x {last_document_index, data_offset, bit_width | count_bit_width << 8 | count << 16}
+//   данные блоков: упакованные разности, затем упакованные числа вхождений (+1 слово запаса у каждых)
+namespace compressed_postings {
+
+const size_t BLOCK_SIZE = 128;
+
+// Дописывает в output поток для пар {номер документа, число вхождений},
+// отсортированных по номеру документа
+void Encode(const std::vector<std::pair<uint32_t, uint32_t>>& postings, std::vector<uint32_t>& output);
+
+// Распаковывает count значений шириной bit_width бит. Цикл без ветвлений
+// по фиксированным смещениям, компилятор его векторизует
+void UnpackBits(const uint32_t* packed, size_t count, uint32_t bit_width, uint32_t* output);
+
+// Последовательный обход сжатого списка с переходом к нужному документу.
+// Поток может прийти из недоверенного файла, поэтому каждый блок проверяется
+// при распаковке: он умещается в available слов, номера документов в нём
+// возрастают, меньше document_count и сходятся с заголовком блока. Иначе
+// выбрасывается std::runtime_error. Блоки, которые Seek пропускает, не читаются
+class Cursor {
+public:
+    Cursor(const uint32_t* data, size_t available, uint64_t document_count);
+
+    bool IsEnd() const;
+    uint32_t GetDocumentIndex() const;
+    uint32_t GetOccurrenceCount() const;
+
+    void Next();
+
+    // Переходит к первому постингу с номером документа не меньше document_index
+    void Seek(uint32_t document_index);
+
+private:
+    const uint32_t* data_;
+    size_t available_;
+    uint64_t document_count_;
+    size_t block_count_;
+    size_t block_ = 0;
+    size_t block_size_ = 0;
+    size_t position_ = 0;
+    uint32_t document_indexes_[BLOCK_SIZE];
+    uint32_t occurrence_counts_[BLOCK_SIZE];
+
+    const uint32_t* GetBlockHeader(size_t block) const;
+    void LoadBlock(size_t block);
+};
+
+} // namespace compressed_postings
@@ -0,0 +1,99 @@
+#include "concurrent_search_server.h"
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+ConcurrentSearchServer::ConcurrentSearchServer(const std::string& stop_words_text)
+    : ConcurrentSearchServer(std::string_view(stop_words_text)) {
+}
+
+ConcurrentSearchServer::ConcurrentSearchServer(std::string_view stop_words_text)
+    : front_(std::make_shared<IndexCopy>(stop_words_text))
+    , back_(std::make_shared<IndexCopy>(stop_words_text)) {
+    PublishFront();
+}
+
+std::shared_ptr<const SearchServer> ConcurrentSearchServer::GetSnapshot() const {
+    return std::atomic_load(&published_);
+}
+
+void ConcurrentSearchServer::AddDocument(int document_id, std::string_view document, DocumentStatus status,
+                                         const std::vector<int>& ratings) {
+    std::lock_guard guard(writer_mutex_);
+    CatchUpBack();
+    PendingOperation operation{false, document_id, std::string(document), status, ratings};
+    Apply(back_->search_server, operation);
+    unpublished_operations_.push_back(std::move(operation));
+}
+
+void ConcurrentSearchServer::RemoveDocument(int document_id) {
+    std::lock_guard guard(writer_mutex_);
+    CatchUpBack();
+    PendingOperation operation;
+    operation.is_removal = true;
+    operation.document_id = document_id;
+    Apply(back_->search_server, operation);
+    unpublished_operations_.push_back(std::move(operation));
+}
+
+void ConcurrentSearchServer::Publish() {
+    std::lock_guard guard(writer_mutex_);
+    CatchUpBack();
+    if (unpublished_operations_.empty()) {
+        return;
+    }
+    // Старая опубликованная копия становится back_, но читатели могут её ещё
+    // держать, поэтому изменения в неё вносятся позже, в CatchUpBack
+    std::swap(front_, back_);
+    PublishFront();
+    lagging_operations_ = std::move(unpublished_operations_);
+    unpublished_operations_.clear();
+}
+
+void ConcurrentSearchServer::Apply(SearchServer& search_server, const PendingOperation& operation) {
+    if (operation.is_removal) {
+        search_server.RemoveDocument(operation.document_id);
+    } else {
+        search_server.AddDocument(operation.document_id, operation.document, operation.status, operation.ratings);
+    }
+}
+
+void ConcurrentSearchServer::PublishFront() {
+    {
+        std::lock_guard guard(front_->mutex);
+        front_->is_published = true;
+    }
+    // Удалитель держит копию живой, даже если снимок переживёт сервер, и будит
+    // писателя, когда копию отпускает последний читатель
+    std::shared_ptr<const SearchServer> published(&front_->search_server,
+        [index_copy = front_](const SearchServer*) {
+            {
+                std::lock_guard guard(index_copy->mutex);
+                index_copy->is_published = false;
+            }
+            index_copy->released.notify_all();
+        });
+    std::atomic_store(&published_, std::move(published));
+}
+
+void ConcurrentSearchServer::CatchUpBack() {
+    if (lagging_operations_.empty()) {
+        return;
+    }
+    {
+        // Новые читатели получают только front_, так что back_ может лишь освободиться
+        std::unique_lock lock(back_->mutex);
+        back_->released.wait(lock, [this] {
+            return !back_->is_published;
+        });
+    }
+    for (const PendingOperation& operation : lagging_operations_) {
+        Apply(back_->search_server, operation);
+    }
+    lagging_operations_.clear();
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "document.h"
+#include "search_server.h"
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Поисковый сервер, который читают и пополняют из разных потоков.
+// Внутри две копии индекса: читатели работают с опубликованной копией,
+// писатель меняет вторую. Publish атомарно меняет копии местами, после чего
+// накопленные изменения догоняют вторую копию, как только её отпустят все
+// читатели. Читатели никогда не ждут писателя.
+// Цена такой схемы: индекс хранится дважды, и каждое изменение применяется
+// к обеим копиям. Писатель после Publish засыпает до тех пор, пока не
+// освободится последний снимок старого поколения, поэтому снимок, который
+// держат долго, задерживает все следующие AddDocument, RemoveDocument и Publish
+class ConcurrentSearchServer {
+public:
+    template <typename StringContainer>
+    explicit ConcurrentSearchServer(const StringContainer& stop_words)
+        : front_(std::make_shared<IndexCopy>(stop_words))
+        , back_(std::make_shared<IndexCopy>(stop_words)) {
+        PublishFront();
+    }
+
+    explicit ConcurrentSearchServer(const std::string& stop_words_text);
+
+    explicit ConcurrentSearchServer(std::string_view stop_words_text);
+
+    // Неизменяемый снимок индекса; остаётся корректным, пока жив указатель.
+    // Снимок не стоит держать дольше запроса: пока он жив, писатель не может
+    // внести изменения во вторую копию после следующей публикации
+    std::shared_ptr<const SearchServer> GetSnapshot() const;
+
+    template <typename... Args>
+    std::vector<Document> FindTopDocuments(Args&&... args) const {
+        return GetSnapshot()->FindTopDocuments(std::forward<Args>(args)...);
+    }
+
+    // Изменения не видны читателям до вызова Publish
+    void AddDocument(int document_id, std::string_view document, DocumentStatus status,
+                     const std::vector<int>& ratings);
+
+    void RemoveDocument(int document_id);
+
+    void Publish();
+
+private:
+    struct PendingOperation {
+        bool is_removal = false;
+        int document_id = 0;
+        std::string document;
+        DocumentStatus status = DocumentStatus::ACTUAL;
+        std::vector<int> ratings;
+    };
+
+    // Копия индекса и признак того, что её держат читатели
+    struct IndexCopy {
+        template <typename StopWords>
+        explicit IndexCopy(const StopWords& stop_words)
+            : search_server(stop_words) {
+        }
+
+        SearchServer search_server;
+        std::mutex mutex;
+        std::condition_variable released;
+        bool is_published = false;
+    };
+
+    // Копии принадлежат писателю и меняются местами при публикации
+    std::shared_ptr<IndexCopy> front_;
+    std::shared_ptr<IndexCopy> back_;
+    // Указатель для читателей на front_->search_server. Когда его отпускает
+    // последний владелец, копия помечается свободной и писатель просыпается.
+    // Читается и заменяется только через std::atomic_load / std::atomic_store
+    std::shared_ptr<const SearchServer> published_;
+
+    std::mutex writer_mutex_;
+    // Изменения, уже внесённые в опубликованную копию, но ещё не в back_
+    std::vector<PendingOperation> lagging_operations_;
+    // Изменения, внесённые в back_ после последней публикации
+    std::vector<PendingOperation> unpublished_operations_;
+
+    void Apply(SearchServer& search_server, const PendingOperation& operation);
+
+    // Отдаёт front_ читателям вместо предыдущей опубликованной копии
+    void PublishFront();
+
+    // Дожидается, пока back_ отпустят все читатели, и догоняет опубликованную копию
+    void CatchUpBack();
+};
@@ -1,7 +1,11 @@
 #include "document.h"
 
 #include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <string>
+#include <vector>
 
 std::ostream& operator<<(std::ostream& output, const Document& document) {
     output << "{ "
@@ -10,4 +14,24 @@ std::ostream& operator<<(std::ostream& output, const Document& document) {
          << "rating = " << document.rating
          << " }";
     return output;
-}
\ No newline at end of file
+}
+
+bool IsMoreRelevant(const Document& lhs, const Document& rhs) {
+    if (std::abs(lhs.relevance - rhs.relevance) < std::numeric_limits<double>::epsilon()) {
+        if (lhs.rating != rhs.rating) {
+            return lhs.rating > rhs.rating;
+        }
+        // Без этого порядок равных документов зависел бы от порядка обхода индекса
+        return lhs.id < rhs.id;
+    }
+    return lhs.relevance > rhs.relevance;
+}
+
+void SelectTopDocuments(std::vector<Document>& documents, size_t top_k) {
+    if (documents.size() > top_k) {
+        std::partial_sort(documents.begin(), documents.begin() + top_k, documents.end(), IsMoreRelevant);
+        documents.resize(top_k);
+    } else {
+        std::sort(documents.begin(), documents.end(), IsMoreRelevant);
+    }
+}
@@ -2,6 +2,8 @@
 
 #include <iostream>
 #include <iterator>
+#include <string_view>
+#include <vector>
 
 struct Document {
     Document() = default;
@@ -24,8 +26,24 @@ enum class DocumentStatus {
     REMOVED,
 };
 
+// Документ для пакетного добавления в SearchServer
+struct NewDocument {
+    int id = 0;
+    std::string_view text;
+    DocumentStatus status = DocumentStatus::ACTUAL;
+    std::vector<int> ratings;
+};
+
 std::ostream& operator<<(std::ostream& output, const Document& document);
 
+// Порядок выдачи: по убыванию релевантности, при равной релевантности по убыванию рейтинга,
+// затем по возрастанию id
+bool IsMoreRelevant(const Document& lhs, const Document& rhs);
+
+// Оставляет top_k самых релевантных документов в порядке выдачи.
+// Упорядочиваются только попавшие в выдачу документы
+void SelectTopDocuments(std::vector<Document>& documents, size_t top_k);
+
 // По сути это одна страница. В ней должны храниться несколько документов и количетсво этих докумнетов.
 template<typename Doc>
 class IteratorRange {
@@ -0,0 +1,26 @@
+#include "document_bitmap.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+void DocumentBitmap::Add(uint32_t document_ordinal) {
+    const size_t word = document_ordinal / 64;
+    if (word >= words_.size()) {
+        words_.resize(word + 1, 0);
+    }
+    words_[word] |= uint64_t{1} << (document_ordinal % 64);
+}
+
+void DocumentBitmap::Remove(uint32_t document_ordinal) {
+    const size_t word = document_ordinal / 64;
+    if (word < words_.size()) {
+        words_[word] &= ~(uint64_t{1} << (document_ordinal % 64));
+    }
+}
+
+void DocumentBitmap::RemoveAll(const std::vector<uint32_t>& document_ordinals) {
+    for (uint32_t document_ordinal : document_ordinals) {
+        Remove(document_ordinal);
+    }
+}
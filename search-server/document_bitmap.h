@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Множество внутренних номеров документов в виде плотной битовой маски.
+// Номера документов идут подряд с нуля, поэтому маска занимает бит на документ,
+// а проверка принадлежности — это чтение одного бита
+class DocumentBitmap {
+public:
+    void Add(uint32_t document_ordinal);
+
+    void Remove(uint32_t document_ordinal);
+
+    bool Contains(uint32_t document_ordinal) const {
+        const size_t word = document_ordinal / 64;
+        return word < words_.size() && (words_[word] >> (document_ordinal % 64) & 1) != 0;
+    }
+
+    // Убирает из множества все номера из document_ordinals
+    void RemoveAll(const std::vector<uint32_t>& document_ordinals);
+
+private:
+    std::vector<uint64_t> words_;
+};
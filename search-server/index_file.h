@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+
+// Бинарный формат индекса, который SearchServer::Save пишет на диск, а
+// MappedSearchServer читает прямо из отображённой в память области.
+// Все секции выровнены по 8 байтам, числа хранятся в порядке байт машины.
+//
+//   Header
+//   Document[document_count]  по возрастанию id
+//   Word[word_count]          по возрастанию слова
+//   Word[stop_word_count]     стоп-слова, posting_count == 0
+//   постинги                  Posting[posting_count] или uint32_t[posting_count], см. PostingFormat
+//   char[strings_size]        тексты слов и стоп-слов без разделителей
+namespace index_file {
+
+enum class PostingFormat : uint32_t {
+    // Постинги слов подряд, внутри слова по возрастанию document_index;
+    // Word::postings_offset — номер первого постинга слова
+    PLAIN = 0,
+    // Потоки compressed_postings слов подряд, в них числа вхождений вместо частот;
+    // Word::postings_offset — номер первого uint32_t потока слова
+    COMPRESSED = 1,
+};
+
+const char MAGIC[8] = {'S', 'R', 'C', 'H', 'I', 'D', 'X', '\0'};
+const uint32_t VERSION = 2;
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    PostingFormat posting_format;
+    uint64_t document_count;
+    uint64_t word_count;
+    uint64_t stop_word_count;
+    uint64_t posting_count;
+    uint64_t strings_size;
+    uint64_t documents_offset;
+    uint64_t words_offset;
+    uint64_t stop_words_offset;
+    uint64_t postings_offset;
+    uint64_t strings_offset;
+    uint64_t file_size;
+};
+
+struct Document {
+    int32_t id;
+    int32_t rating;
+    int32_t status;
+    // Без стоп-слов: частота слова — число вхождений, умноженное на 1.0 / word_count
+    uint32_t word_count;
+};
+
+struct Word {
+    uint64_t string_offset;
+    uint64_t postings_offset;
+    uint32_t string_length;
+    uint32_t posting_count;
+    // IDF на момент сохранения: файл не меняется, поэтому считать его заново не нужно
+    double inverse_document_freq;
+};
+
+struct Posting {
+    // Позиция документа в таблице документов
+    uint32_t document_index;
+    uint32_t reserved;
+    double term_freq;
+};
+
+static_assert(sizeof(Header) == 104);
+static_assert(sizeof(Document) == 16);
+static_assert(sizeof(Word) == 32);
+static_assert(sizeof(Posting) == 16);
+
+} // namespace index_file
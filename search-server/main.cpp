@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <iostream>
 #include <map>
 #include <set>
@@ -17,20 +18,26 @@ using namespace std;
 
 int main() {
     SearchServer search_server("and in at"s);
-    RequestQueue request_queue(search_server);
+    // Каждый запрос приходит в свою минуту, чтобы показать смену суток
+    int64_t minute = 0;
+    RequestQueue request_queue(search_server, [&minute] {
+        return minute;
+    });
     search_server.AddDocument(1, "curly cat curly tail"s, DocumentStatus::ACTUAL, {7, 2, 7});
     search_server.AddDocument(2, "curly dog and fancy collar"s, DocumentStatus::ACTUAL, {1, 2, 3});
     search_server.AddDocument(3, "big cat fancy collar "s, DocumentStatus::ACTUAL, {1, 2, 8});
     search_server.AddDocument(4, "big dog sparrow Eugene"s, DocumentStatus::ACTUAL, {1, 3, 2});
     search_server.AddDocument(5, "big dog sparrow Vasiliy"s, DocumentStatus::ACTUAL, {1, 1, 1});
     // 1439 запросов с нулевым результатом
-    for (int i = 0; i < 1439; ++i) {
+    for (int i = 0; i < 1439; ++i, ++minute) {
         request_queue.AddFindRequest("empty request"s);
     }
     // все еще 1439 запросов с нулевым результатом
     request_queue.AddFindRequest("curly dog"s);
+    ++minute;
     // новые сутки, первый запрос удален, 1438 запросов с нулевым результатом
     request_queue.AddFindRequest("big collar"s);
+    ++minute;
     // первый запрос удален, 1437 запросов с нулевым результатом
     request_queue.AddFindRequest("sparrow"s);
     cout << "Total empty requests: "s << request_queue.GetNoResultRequests() << endl;
@@ -0,0 +1,228 @@
+#include "mapped_search_server.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedSearchServer::MappedSearchServer(const std::string& path) {
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open index file " + path);
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || static_cast<size_t>(file_stat.st_size) < sizeof(index_file::Header)) {
+        close(fd);
+        throw std::runtime_error("Index file " + path + " is truncated");
+    }
+    size_ = file_stat.st_size;
+    data_ = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data_ == MAP_FAILED) {
+        data_ = nullptr;
+        throw std::runtime_error("Cannot map index file " + path);
+    }
+
+    const char* bytes = static_cast<const char*>(data_);
+    header_ = reinterpret_cast<const index_file::Header*>(bytes);
+    try {
+        Validate();
+        documents_ = reinterpret_cast<const index_file::Document*>(bytes + header_->documents_offset);
+        words_ = reinterpret_cast<const index_file::Word*>(bytes + header_->words_offset);
+        if (header_->posting_format == index_file::PostingFormat::COMPRESSED) {
+            compressed_postings_ = reinterpret_cast<const uint32_t*>(bytes + header_->postings_offset);
+        } else {
+            postings_ = reinterpret_cast<const index_file::Posting*>(bytes + header_->postings_offset);
+        }
+        strings_ = bytes + header_->strings_offset;
+
+        const auto* file_stop_words = reinterpret_cast<const index_file::Word*>(bytes + header_->stop_words_offset);
+        std::set<std::string, std::less<>> stop_words;
+        for (uint64_t i = 0; i < header_->stop_word_count; ++i) {
+            stop_words.emplace(GetWordString(file_stop_words[i]));
+        }
+        stop_words_ = StopWordTable(stop_words);
+    } catch (...) {
+        Unmap();
+        throw;
+    }
+}
+
+MappedSearchServer::MappedSearchServer(MappedSearchServer&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedSearchServer& MappedSearchServer::operator=(MappedSearchServer&& other) noexcept {
+    if (this != &other) {
+        Unmap();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        header_ = std::exchange(other.header_, nullptr);
+        documents_ = std::exchange(other.documents_, nullptr);
+        words_ = std::exchange(other.words_, nullptr);
+        postings_ = std::exchange(other.postings_, nullptr);
+        compressed_postings_ = std::exchange(other.compressed_postings_, nullptr);
+        strings_ = std::exchange(other.strings_, nullptr);
+        stop_words_ = std::move(other.stop_words_);
+    }
+    return *this;
+}
+
+MappedSearchServer::~MappedSearchServer() {
+    Unmap();
+}
+
+std::vector<Document> MappedSearchServer::FindTopDocuments(std::string_view raw_query, DocumentStatus status,
+                                                          size_t top_k) const {
+    return FindTopDocuments(
+        raw_query, [status](int, DocumentStatus document_status, int) {
+            return document_status == status;
+        }, top_k);
+}
+
+std::vector<Document> MappedSearchServer::FindTopDocuments(std::string_view raw_query) const {
+    return FindTopDocuments(raw_query, DocumentStatus::ACTUAL);
+}
+
+std::tuple<std::vector<std::string_view>, DocumentStatus> MappedSearchServer::MatchDocument(std::string_view raw_query,
+                                                                                int document_id) const {
+    const auto* documents_end = documents_ + header_->document_count;
+    const auto* document = std::lower_bound(documents_, documents_end, document_id,
+        [](const index_file::Document& lhs, int id) {
+            return lhs.id < id;
+        });
+    if (document == documents_end || document->id != document_id) {
+        throw std::out_of_range("Invalid document_id");
+    }
+    const uint32_t document_index = document - documents_;
+    const auto status = static_cast<DocumentStatus>(document->status);
+    const auto query = ParseQuery(raw_query, stop_words_);
+
+    for (const auto& [word, _] : query.minus_words) {
+        const index_file::Word* file_word = FindWord(word);
+        if (file_word != nullptr && ContainsDocument(*file_word, document_index)) {
+            return {std::vector<std::string_view>{}, status};
+        }
+    }
+
+    std::vector<std::string_view> matched_words;
+    for (const auto& [word, _] : query.plus_words) {
+        const index_file::Word* file_word = FindWord(word);
+        if (file_word != nullptr && ContainsDocument(*file_word, document_index)) {
+            matched_words.push_back(GetWordString(*file_word));
+        }
+    }
+    return {matched_words, status};
+}
+
+int MappedSearchServer::GetDocumentCount() const {
+    return static_cast<int>(header_->document_count);
+}
+
+void MappedSearchServer::Validate() const {
+    if (std::memcmp(header_->magic, index_file::MAGIC, sizeof(index_file::MAGIC)) != 0) {
+        throw std::runtime_error("Not a search index file");
+    }
+    if (header_->version != index_file::VERSION) {
+        throw std::runtime_error("Unsupported index file version " + std::to_string(header_->version));
+    }
+    if (header_->posting_format != index_file::PostingFormat::PLAIN
+        && header_->posting_format != index_file::PostingFormat::COMPRESSED) {
+        throw std::runtime_error("Unsupported posting format");
+    }
+    const size_t posting_size = header_->posting_format == index_file::PostingFormat::COMPRESSED
+        ? sizeof(uint32_t) : sizeof(index_file::Posting);
+    const auto section_fits = [this](uint64_t offset, uint64_t count, uint64_t item_size) {
+        return offset % 8 == 0 && offset <= size_ && count <= (size_ - offset) / item_size;
+    };
+    if (header_->file_size != size_
+        || !section_fits(header_->documents_offset, header_->document_count, sizeof(index_file::Document))
+        || !section_fits(header_->words_offset, header_->word_count, sizeof(index_file::Word))
+        || !section_fits(header_->stop_words_offset, header_->stop_word_count, sizeof(index_file::Word))
+        || !section_fits(header_->postings_offset, header_->posting_count, posting_size)
+        || header_->strings_offset > size_ || header_->strings_size > size_ - header_->strings_offset) {
+        throw std::runtime_error("Index file is corrupted");
+    }
+}
+
+std::string_view MappedSearchServer::GetWordString(const index_file::Word& file_word) const {
+    if (file_word.string_offset > header_->strings_size
+        || file_word.string_length > header_->strings_size - file_word.string_offset) {
+        throw std::runtime_error("Index file is corrupted");
+    }
+    return {strings_ + file_word.string_offset, file_word.string_length};
+}
+
+const index_file::Word* MappedSearchServer::FindWord(std::string_view word) const {
+    const auto* words_end = words_ + header_->word_count;
+    const auto* file_word = std::lower_bound(words_, words_end, word,
+        [this](const index_file::Word& lhs, std::string_view rhs) {
+            return GetWordString(lhs) < rhs;
+        });
+    if (file_word == words_end || GetWordString(*file_word) != word) {
+        return nullptr;
+    }
+    // Сжатый поток дальше проверяет Cursor, здесь нужно только, чтобы он начинался внутри секции
+    const uint64_t available = file_word->postings_offset <= header_->posting_count
+        ? header_->posting_count - file_word->postings_offset : 0;
+    if (compressed_postings_ != nullptr ? available == 0 : file_word->posting_count > available) {
+        throw std::runtime_error("Index file is corrupted");
+    }
+    return file_word;
+}
+
+compressed_postings::Cursor MappedSearchServer::GetCursor(const index_file::Word& file_word) const {
+    return compressed_postings::Cursor(compressed_postings_ + file_word.postings_offset,
+                                       header_->posting_count - file_word.postings_offset, header_->document_count);
+}
+
+bool MappedSearchServer::ContainsDocument(const index_file::Word& file_word, uint32_t document_index) const {
+    if (compressed_postings_ != nullptr) {
+        compressed_postings::Cursor cursor = GetCursor(file_word);
+        cursor.Seek(document_index);
+        return !cursor.IsEnd() && cursor.GetDocumentIndex() == document_index;
+    }
+    const auto* postings_begin = postings_ + file_word.postings_offset;
+    const auto* postings_end = postings_begin + file_word.posting_count;
+    const auto* posting = std::lower_bound(postings_begin, postings_end, document_index,
+        [](const index_file::Posting& lhs, uint32_t index) {
+            return lhs.document_index < index;
+        });
+    return posting != postings_end && posting->document_index == document_index;
+}
+
+std::vector<uint32_t> MappedSearchServer::CollectExcludedDocuments(const Query& query) const {
+    std::vector<uint32_t> excluded_indexes;
+    for (const auto& [word, _] : query.minus_words) {
+        const index_file::Word* file_word = FindWord(word);
+        if (file_word == nullptr) {
+            continue;
+        }
+        const auto middle = excluded_indexes.size();
+        ForEachPosting(*file_word, [&excluded_indexes](uint32_t document_index, double) {
+            excluded_indexes.push_back(document_index);
+        });
+        std::inplace_merge(excluded_indexes.begin(), excluded_indexes.begin() + middle, excluded_indexes.end());
+    }
+    excluded_indexes.erase(std::unique(excluded_indexes.begin(), excluded_indexes.end()), excluded_indexes.end());
+    return excluded_indexes;
+}
+
+void MappedSearchServer::Unmap() {
+    if (data_ != nullptr) {
+        munmap(data_, size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include "document.h"
+#include "index_file.h"
+#include "compressed_postings.h"
+#include "query.h"
+#include "search_server.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+// Индекс только для чтения, работающий прямо поверх файла, сохранённого
+// SearchServer::Save. Файл отображается в память целиком и не разбирается,
+// поэтому открытие не зависит от размера корпуса, а несколько процессов
+// делят одни и те же страницы кэша
+class MappedSearchServer {
+public:
+    explicit MappedSearchServer(const std::string& path);
+
+    MappedSearchServer(const MappedSearchServer&) = delete;
+    MappedSearchServer& operator=(const MappedSearchServer&) = delete;
+    MappedSearchServer(MappedSearchServer&& other) noexcept;
+    MappedSearchServer& operator=(MappedSearchServer&& other) noexcept;
+
+    ~MappedSearchServer();
+
+    template <typename DocumentPredicate>
+    std::vector<Document> FindTopDocuments(std::string_view raw_query, DocumentPredicate document_predicate,
+                                      size_t top_k = MAX_RESULT_DOCUMENT_COUNT) const {
+        const auto query = ParseQuery(raw_query, stop_words_);
+
+        // Документы с минус-словами отбрасываются до подсчёта релевантности и вызова предиката
+        const std::vector<uint32_t> excluded_indexes = CollectExcludedDocuments(query);
+        std::map<uint32_t, double> document_to_relevance;
+        for (const auto& [word, _] : query.plus_words) {
+            const index_file::Word* file_word = FindWord(word);
+            if (file_word == nullptr) {
+                continue;
+            }
+            auto excluded = excluded_indexes.begin();
+            ForEachPosting(*file_word, [&](uint32_t document_index, double term_freq) {
+                excluded = std::lower_bound(excluded, excluded_indexes.end(), document_index);
+                if (excluded != excluded_indexes.end() && *excluded == document_index) {
+                    return;
+                }
+                const auto& document = documents_[document_index];
+                if (document_predicate(document.id, static_cast<DocumentStatus>(document.status), document.rating)) {
+                    document_to_relevance[document_index] += term_freq * file_word->inverse_document_freq;
+                }
+            });
+        }
+
+        std::vector<Document> matched_documents;
+        matched_documents.reserve(document_to_relevance.size());
+        for (const auto& [document_index, relevance] : document_to_relevance) {
+            const auto& document = documents_[document_index];
+            matched_documents.push_back({document.id, relevance, document.rating});
+        }
+        SelectTopDocuments(matched_documents, top_k);
+        return matched_documents;
+    }
+
+    std::vector<Document> FindTopDocuments(std::string_view raw_query, DocumentStatus status,
+                                      size_t top_k = MAX_RESULT_DOCUMENT_COUNT) const;
+
+    std::vector<Document> FindTopDocuments(std::string_view raw_query) const;
+
+    // Найденные слова ссылаются на отображённый файл
+    std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocument(std::string_view raw_query, int document_id) const;
+
+    int GetDocumentCount() const;
+
+private:
+    void* data_ = nullptr;
+    size_t size_ = 0;
+
+    const index_file::Header* header_ = nullptr;
+    const index_file::Document* documents_ = nullptr;
+    const index_file::Word* words_ = nullptr;
+    // Заполнен ровно один из указателей, в зависимости от формата постингов
+    const index_file::Posting* postings_ = nullptr;
+    const uint32_t* compressed_postings_ = nullptr;
+    const char* strings_ = nullptr;
+    StopWordTable stop_words_;
+
+    // При открытии проверяются только заголовок и границы секций, чтобы не читать
+    // весь файл. Слово проверяется, когда поиск к нему обращается: строка, диапазон
+    // постингов и номера документов в них. Повреждение даёт std::runtime_error
+    void Validate() const;
+
+    std::string_view GetWordString(const index_file::Word& file_word) const;
+
+    // Найденное слово проверено: его постинги лежат внутри секции постингов
+    const index_file::Word* FindWord(std::string_view word) const;
+
+    compressed_postings::Cursor GetCursor(const index_file::Word& file_word) const;
+
+    bool ContainsDocument(const index_file::Word& file_word, uint32_t document_index) const;
+
+    // Отсортированные номера документов, содержащих хотя бы одно минус-слово
+    std::vector<uint32_t> CollectExcludedDocuments(const Query& query) const;
+
+    template <typename Callback>
+    void ForEachPosting(const index_file::Word& file_word, Callback callback) const {
+        if (compressed_postings_ != nullptr) {
+            for (compressed_postings::Cursor cursor = GetCursor(file_word); !cursor.IsEnd(); cursor.Next()) {
+                // Частота считается так же, как в SearchServer, и релевантность совпадает до бита
+                const uint32_t document_index = cursor.GetDocumentIndex();
+                callback(document_index, cursor.GetOccurrenceCount() * (1.0 / documents_[document_index].word_count));
+            }
+        } else {
+            const index_file::Posting* postings = postings_ + file_word.postings_offset;
+            for (uint32_t i = 0; i < file_word.posting_count; ++i) {
+                // Поиск обращается к таблице документов по номеру из постинга
+                if (postings[i].document_index >= header_->document_count) {
+                    throw std::runtime_error("Index file is corrupted");
+                }
+                callback(postings[i].document_index, postings[i].term_freq);
+            }
+        }
+    }
+
+    void Unmap();
+};
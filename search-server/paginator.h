@@ -1,51 +1,134 @@
 #pragma once
 
-#include <vector>
+#include "document.h"
+
+#include <algorithm>
+#include <cstddef>
 #include <iterator>
+#include <stdexcept>
+#include <type_traits>
 
+// Разбивает диапазон на страницы по page_size элементов, последняя может быть короче.
+// Страницы не хранятся, а строятся при обращении: память не зависит от числа
+// страниц. Для итераторов произвольного доступа страница k и число страниц
+// находятся за O(1), для остальных диапазон проходится только до нужной страницы
 template<typename Doc>
 class Paginator {
 public:
-    explicit Paginator(Doc begin, Doc end, size_t page_size){
-        int count = distance(begin, end) / page_size;
-        Doc begin_ = begin;
-        Doc end_ = end;
-        if (distance(begin, end) / page_size == 1){
-            for (int i = 0; i < count; ++i){
-                Doc start = begin_;
-                advance(begin_, page_size);
-                Doc finish = begin_;
-                pages_.push_back(IteratorRange<Doc>(start, finish));
-            }
-            pages_.push_back(IteratorRange<Doc>(begin_, end_));
-        } else{
-            for (int i = 0; i < count; ++i){
-                Doc start = begin_;
-                advance(begin_, page_size);
-                Doc finish = begin_;
-                pages_.push_back(IteratorRange<Doc>(start, finish));
-            }
+    class PageIterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = IteratorRange<Doc>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = IteratorRange<Doc>;
+
+        PageIterator(Doc page_begin, Doc end, size_t page_size)
+            : page_begin_(page_begin)
+            , page_end_(AdvanceUpTo(page_begin, end, page_size))
+            , end_(end)
+            , page_size_(page_size) {
+        }
+
+        IteratorRange<Doc> operator*() const {
+            Doc page_begin = page_begin_;
+            Doc page_end = page_end_;
+            return IteratorRange<Doc>(page_begin, page_end);
+        }
+
+        PageIterator& operator++() {
+            page_begin_ = page_end_;
+            page_end_ = AdvanceUpTo(page_begin_, end_, page_size_);
+            return *this;
+        }
+
+        PageIterator operator++(int) {
+            PageIterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        // Сравниваются только итераторы одного Paginator
+        bool operator==(const PageIterator& other) const {
+            return page_begin_ == other.page_begin_;
+        }
+
+        bool operator!=(const PageIterator& other) const {
+            return !(*this == other);
+        }
+
+    private:
+        Doc page_begin_;
+        Doc page_end_;
+        Doc end_;
+        size_t page_size_;
+    };
+
+    explicit Paginator(Doc begin, Doc end, size_t page_size)
+        : begin_(begin)
+        , end_(end)
+        , page_size_(page_size) {
+        if (page_size == 0) {
+            throw std::invalid_argument("Page size must be positive");
         }
     }
-    
-    auto begin() const {
-        return pages_.begin();
+
+    PageIterator begin() const {
+        return PageIterator(begin_, end_, page_size_);
+    }
+
+    PageIterator end() const {
+        return PageIterator(end_, end_, page_size_);
     }
-    
-    auto end() const {
-        return pages_.end();
+
+    // Без произвольного доступа проходит весь диапазон
+    size_t size() const {
+        const auto item_count = static_cast<size_t>(std::distance(begin_, end_));
+        return (item_count + page_size_ - 1) / page_size_;
     }
-    
-    size_t size() {
-        return pages_.size();
+
+    // Страница с номером page_index, начиная с нуля
+    IteratorRange<Doc> operator[](size_t page_index) const {
+        if constexpr (IS_RANDOM_ACCESS) {
+            if (page_index >= size()) {
+                throw std::out_of_range("Invalid page index");
+            }
+            return *PageIterator(begin_ + page_index * page_size_, end_, page_size_);
+        } else {
+            PageIterator page = begin();
+            for (size_t i = 0; i < page_index && page != end(); ++i) {
+                ++page;
+            }
+            if (page == end()) {
+                throw std::out_of_range("Invalid page index");
+            }
+            return *page;
+        }
     }
-    
+
 private:
-    std::vector<IteratorRange<Doc>> pages_;
+    static constexpr bool IS_RANDOM_ACCESS = std::is_base_of_v<std::random_access_iterator_tag,
+        typename std::iterator_traits<Doc>::iterator_category>;
+
+    Doc begin_;
+    Doc end_;
+    size_t page_size_;
+
+    // Сдвигает it на count элементов, но не дальше end
+    static Doc AdvanceUpTo(Doc it, Doc end, size_t count) {
+        if constexpr (IS_RANDOM_ACCESS) {
+            return it + std::min(static_cast<std::ptrdiff_t>(count), end - it);
+        } else {
+            for (; count > 0 && it != end; --count) {
+                ++it;
+            }
+            return it;
+        }
+    }
 };
 
 // Функция, которая возвращает объект класса Paginator
 template <typename Container>
 auto Paginate(const Container& c, size_t page_size) {
     return Paginator(begin(c), end(c), page_size);
-}
\ No newline at end of file
+}
@@ -0,0 +1,77 @@
+#include "process_queries.h"
+
+#include <algorithm>
+#include <execution>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+DocumentsJoined::DocumentsJoined(std::vector<Document> documents, std::vector<size_t> query_offsets)
+    : documents_(std::move(documents))
+    , query_offsets_(std::move(query_offsets)) {
+}
+
+DocumentsJoined::Iterator DocumentsJoined::begin() const {
+    return documents_.begin();
+}
+
+DocumentsJoined::Iterator DocumentsJoined::end() const {
+    return documents_.end();
+}
+
+size_t DocumentsJoined::size() const {
+    return documents_.size();
+}
+
+bool DocumentsJoined::empty() const {
+    return documents_.empty();
+}
+
+IteratorRange<DocumentsJoined::Iterator> DocumentsJoined::GetQueryDocuments(size_t query_index) const {
+    if (query_index + 1 >= query_offsets_.size()) {
+        throw std::out_of_range("Invalid query index");
+    }
+    Iterator query_begin = documents_.begin() + query_offsets_[query_index];
+    Iterator query_end = documents_.begin() + query_offsets_[query_index + 1];
+    return IteratorRange<Iterator>(query_begin, query_end);
+}
+
+std::vector<std::vector<Document>> ProcessQueries(
+    const SearchServer& search_server,
+    const std::vector<std::string>& queries) {
+    std::vector<std::vector<Document>> documents_lists(queries.size());
+    std::transform(std::execution::par, queries.begin(), queries.end(), documents_lists.begin(),
+        [&search_server](const std::string& query) {
+            return search_server.FindTopDocuments(query);
+        });
+    return documents_lists;
+}
+
+DocumentsJoined ProcessQueriesJoined(
+    const SearchServer& search_server,
+    const std::vector<std::string>& queries) {
+    // Запрос находит не больше MAX_RESULT_DOCUMENT_COUNT документов, поэтому каждый
+    // пишет результаты в свой участок общего вектора, а незанятые места затем убираются
+    std::vector<Document> documents(queries.size() * MAX_RESULT_DOCUMENT_COUNT);
+    std::vector<size_t> query_offsets(queries.size() + 1);
+    std::vector<size_t> query_indexes(queries.size());
+    std::iota(query_indexes.begin(), query_indexes.end(), 0);
+    std::for_each(std::execution::par, query_indexes.begin(), query_indexes.end(),
+        [&](size_t query_index) {
+            const std::vector<Document> query_documents = search_server.FindTopDocuments(queries[query_index]);
+            std::copy(query_documents.begin(), query_documents.end(),
+                      documents.begin() + query_index * MAX_RESULT_DOCUMENT_COUNT);
+            query_offsets[query_index + 1] = query_documents.size();
+        });
+
+    for (size_t query_index = 0; query_index < queries.size(); ++query_index) {
+        const auto slot = documents.begin() + query_index * MAX_RESULT_DOCUMENT_COUNT;
+        const size_t offset = query_offsets[query_index];
+        std::copy(slot, slot + query_offsets[query_index + 1], documents.begin() + offset);
+        query_offsets[query_index + 1] += offset;
+    }
+    documents.resize(query_offsets.back());
+    return DocumentsJoined(std::move(documents), std::move(query_offsets));
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "document.h"
+#include "search_server.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Результаты нескольких запросов подряд в одном векторе: обходятся как одна
+// плоская последовательность документов, а по смещениям видно, где результаты
+// каждого запроса
+class DocumentsJoined {
+public:
+    using Iterator = std::vector<Document>::const_iterator;
+
+    // query_offsets[i] — начало результатов i-го запроса, последний элемент равен documents.size()
+    DocumentsJoined(std::vector<Document> documents, std::vector<size_t> query_offsets);
+
+    Iterator begin() const;
+    Iterator end() const;
+
+    size_t size() const;
+    bool empty() const;
+
+    // Результаты запроса с номером query_index, начиная с нуля
+    IteratorRange<Iterator> GetQueryDocuments(size_t query_index) const;
+
+private:
+    std::vector<Document> documents_;
+    std::vector<size_t> query_offsets_;
+};
+
+// Выполняет запросы параллельно, i-й элемент результата соответствует i-му запросу
+std::vector<std::vector<Document>> ProcessQueries(
+    const SearchServer& search_server,
+    const std::vector<std::string>& queries);
+
+DocumentsJoined ProcessQueriesJoined(
+    const SearchServer& search_server,
+    const std::vector<std::string>& queries);
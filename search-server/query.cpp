@@ -0,0 +1,68 @@
+#include "query.h"
+#include "string_processing.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+struct QueryWord {
+    HashedWord data;
+    bool is_minus;
+    bool is_stop;
+};
+
+QueryWord ParseQueryWord(std::string_view text, const StopWordTable& stop_words) {
+    if (text.empty()) {
+        throw std::invalid_argument("Query word is empty");
+    }
+    std::string_view word = text;
+    bool is_minus = false;
+    if (word[0] == '-') {
+        is_minus = true;
+        word.remove_prefix(1);
+    }
+    if (word.empty() || word[0] == '-' || !IsValidWord(word)) {
+        throw std::invalid_argument("Query word " + std::string(text) + " is invalid");
+    }
+
+    const HashedWord hashed_word = HashWord(word);
+    return {hashed_word, is_minus, stop_words.Contains(hashed_word)};
+}
+
+} // namespace
+
+Query ParseQuery(std::string_view text, const StopWordTable& stop_words, bool remove_duplicates) {
+    Query result;
+    for (std::string_view word : SplitIntoWords(text)) {
+        const auto query_word = ParseQueryWord(word, stop_words);
+        if (!query_word.is_stop) {
+            if (query_word.is_minus) {
+                result.minus_words.push_back(query_word.data);
+            } else {
+                result.plus_words.push_back(query_word.data);
+            }
+        }
+    }
+    if (remove_duplicates) {
+        RemoveDuplicateWords(result.plus_words);
+        RemoveDuplicateWords(result.minus_words);
+    }
+    return result;
+}
+
+void RemoveDuplicateWords(std::vector<std::string_view>& words) {
+    std::sort(words.begin(), words.end());
+    words.erase(std::unique(words.begin(), words.end()), words.end());
+}
+
+void RemoveDuplicateWords(std::vector<HashedWord>& words) {
+    std::sort(words.begin(), words.end(),
+        [](const HashedWord& lhs, const HashedWord& rhs) {
+            return lhs.word < rhs.word;
+        });
+    words.erase(std::unique(words.begin(), words.end()), words.end());
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "stop_word_table.h"
+#include "string_processing.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Слова запроса ссылаются на текст запроса. Хеш слова посчитан при разборе,
+// и индекс ищет слово по нему, не хешируя слово ещё раз
+struct Query {
+    std::vector<HashedWord> plus_words;
+    std::vector<HashedWord> minus_words;
+};
+
+// Стоп-слова в запрос не попадают. Без удаления повторов слова остаются
+// в порядке запроса, иначе отсортированы и уникальны
+Query ParseQuery(std::string_view text, const StopWordTable& stop_words, bool remove_duplicates = true);
+
+void RemoveDuplicateWords(std::vector<std::string_view>& words);
+
+void RemoveDuplicateWords(std::vector<HashedWord>& words);
@@ -0,0 +1,84 @@
+#include "query_cache.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+QueryCache::QueryCache(const SearchServer& search_server, size_t capacity)
+    : search_server_(search_server)
+    , capacity_(capacity) {
+}
+
+std::vector<Document> QueryCache::FindTopDocuments(std::string_view raw_query, DocumentStatus status,
+                                                  size_t top_k) {
+    // Разобранный запрос нужен и для ключа, и для поиска при промахе
+    const Query query = search_server_.NormalizeQuery(raw_query);
+    const std::string key = MakeKey(query, status, top_k);
+    const uint64_t generation = search_server_.GetGeneration();
+    {
+        std::lock_guard guard(mutex_);
+        DropIfStale(generation);
+        const auto it = key_to_entry_.find(key);
+        if (it != key_to_entry_.end()) {
+            entries_.splice(entries_.begin(), entries_, it->second);
+            hit_count_.fetch_add(1, std::memory_order_relaxed);
+            return it->second->second;
+        }
+    }
+    miss_count_.fetch_add(1, std::memory_order_relaxed);
+
+    // Поиск идёт без блокировки, чтобы промахи в разных потоках не ждали друг друга
+    std::vector<Document> results = search_server_.FindTopDocuments(query, status, top_k);
+    if (capacity_ == 0) {
+        return results;
+    }
+
+    std::lock_guard guard(mutex_);
+    DropIfStale(generation);
+    if (generation_ != generation || key_to_entry_.count(key) > 0) {
+        return results;
+    }
+    entries_.emplace_front(key, results);
+    key_to_entry_.emplace(entries_.front().first, entries_.begin());
+    if (entries_.size() > capacity_) {
+        key_to_entry_.erase(entries_.back().first);
+        entries_.pop_back();
+    }
+    return results;
+}
+
+std::vector<Document> QueryCache::FindTopDocuments(std::string_view raw_query) {
+    return FindTopDocuments(raw_query, DocumentStatus::ACTUAL);
+}
+
+QueryCache::Stats QueryCache::GetStats() const {
+    return {hit_count_.load(std::memory_order_relaxed), miss_count_.load(std::memory_order_relaxed)};
+}
+
+std::string QueryCache::MakeKey(const Query& query, DocumentStatus status, size_t top_k) {
+    // Слова не содержат пробелов и управляющих символов, поэтому ими можно разделять части ключа
+    std::string key = std::to_string(static_cast<int>(status)) + ' ' + std::to_string(top_k) + '\n';
+    for (const auto& [word, _] : query.plus_words) {
+        key += word;
+        key += ' ';
+    }
+    key += '\n';
+    for (const auto& [word, _] : query.minus_words) {
+        key += word;
+        key += ' ';
+    }
+    return key;
+}
+
+void QueryCache::DropIfStale(uint64_t generation) {
+    // Поколение индекса только растёт, поэтому более старое значение просто не сбрасывает кэш
+    if (generation > generation_) {
+        entries_.clear();
+        key_to_entry_.clear();
+        generation_ = generation;
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "document.h"
+#include "query.h"
+#include "search_server.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Кэш результатов поиска перед SearchServer с вытеснением давно не
+// использованных запросов. Ключ — разобранный запрос, поэтому запросы,
+// отличающиеся порядком слов, повторами или стоп-словами, попадают в одну
+// запись. При любом изменении индекса кэш целиком сбрасывается.
+// Кэшируется только отбор по статусу: произвольный предикат нельзя сравнить с другим
+class QueryCache {
+public:
+    struct Stats {
+        uint64_t hit_count = 0;
+        uint64_t miss_count = 0;
+    };
+
+    QueryCache(const SearchServer& search_server, size_t capacity);
+
+    std::vector<Document> FindTopDocuments(std::string_view raw_query, DocumentStatus status,
+                                      size_t top_k = MAX_RESULT_DOCUMENT_COUNT);
+
+    std::vector<Document> FindTopDocuments(std::string_view raw_query);
+
+    Stats GetStats() const;
+
+private:
+    using Entry = std::pair<std::string, std::vector<Document>>;
+
+    const SearchServer& search_server_;
+    const size_t capacity_;
+
+    std::mutex mutex_;
+    // В начале списка самые недавно использованные записи
+    std::list<Entry> entries_;
+    std::unordered_map<std::string_view, std::list<Entry>::iterator> key_to_entry_;
+    uint64_t generation_ = 0;
+
+    std::atomic<uint64_t> hit_count_{0};
+    std::atomic<uint64_t> miss_count_{0};
+
+    static std::string MakeKey(const Query& query, DocumentStatus status, size_t top_k);
+
+    // Вызывается под mutex_
+    void DropIfStale(uint64_t generation);
+};
@@ -0,0 +1,23 @@
+#include "relevance_accumulator.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+void RelevanceAccumulator::Reset(size_t document_count) {
+    if (++generation_ == 0) {
+        // Счётчик переполнился: старые поколения могли бы совпасть с новыми
+        std::fill(generations_.begin(), generations_.end(), 0);
+        generation_ = 1;
+    }
+    if (generations_.size() < document_count) {
+        generations_.resize(document_count, 0);
+        relevances_.resize(document_count);
+    }
+    touched_ordinals_.clear();
+}
+
+size_t RelevanceAccumulator::GetTouchedCount() const {
+    return touched_ordinals_.size();
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Релевантности документов одного запроса в плоском массиве по номеру документа.
+// Массивы переиспользуются между запросами: значение считается заданным, только
+// если его поколение совпадает с текущим, поэтому сброс перед запросом не трогает
+// массив, а обход идёт лишь по документам, которые запрос затронул
+class RelevanceAccumulator {
+public:
+    // Начинает новый запрос по документам с номерами меньше document_count
+    void Reset(size_t document_count);
+
+    void Add(uint32_t document_ordinal, double relevance) {
+        if (generations_[document_ordinal] != generation_) {
+            generations_[document_ordinal] = generation_;
+            relevances_[document_ordinal] = 0.0;
+            touched_ordinals_.push_back(document_ordinal);
+        }
+        relevances_[document_ordinal] += relevance;
+    }
+
+    size_t GetTouchedCount() const;
+
+    // Обходит затронутые документы в порядке первого обращения
+    template <typename Callback>
+    void ForEach(Callback callback) const {
+        for (uint32_t document_ordinal : touched_ordinals_) {
+            callback(document_ordinal, relevances_[document_ordinal]);
+        }
+    }
+
+private:
+    std::vector<double> relevances_;
+    std::vector<uint32_t> generations_;
+    std::vector<uint32_t> touched_ordinals_;
+    uint32_t generation_ = 0;
+};
@@ -0,0 +1,54 @@
+#include "remove_duplicates.h"
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using TermSet = std::vector<std::string_view>;
+
+struct TermSetHasher {
+    size_t operator()(const TermSet& terms) const {
+        size_t hash = terms.size();
+        for (std::string_view term : terms) {
+            hash = hash * 37 + hasher_(term);
+        }
+        return hash;
+    }
+
+private:
+    std::hash<std::string_view> hasher_;
+};
+
+} // namespace
+
+std::vector<int> RemoveDuplicates(SearchServer& search_server) {
+    // Документы обходятся по возрастанию id, поэтому первым в наборе
+    // оказывается документ с наименьшим id, а остальные считаются дубликатами
+    std::vector<int> document_ids(search_server.begin(), search_server.end());
+    std::sort(document_ids.begin(), document_ids.end());
+    std::unordered_set<TermSet, TermSetHasher> seen_term_sets;
+    std::vector<int> duplicate_ids;
+    for (const int document_id : document_ids) {
+        const auto& word_freqs = search_server.GetWordFrequencies(document_id);
+        TermSet terms;
+        terms.reserve(word_freqs.size());
+        for (const auto& [word, _] : word_freqs) {
+            terms.push_back(word);
+        }
+        if (!seen_term_sets.insert(std::move(terms)).second) {
+            duplicate_ids.push_back(document_id);
+        }
+    }
+
+    for (const int document_id : duplicate_ids) {
+        std::cout << "Found duplicate document id " << document_id << std::endl;
+        search_server.RemoveDocument(document_id);
+    }
+    return duplicate_ids;
+}
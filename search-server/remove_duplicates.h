@@ -0,0 +1,9 @@
+#pragma once
+
+#include "search_server.h"
+
+#include <vector>
+
+// Удаляет документы с тем же набором слов, что и у документа с меньшим id.
+// Возвращает id удалённых документов по возрастанию
+std::vector<int> RemoveDuplicates(SearchServer& search_server);
@@ -1,25 +1,42 @@
 #include "request_queue.h"
 
+#include <chrono>
+#include <cstdint>
 #include <vector>
 #include <string>
+#include <string_view>
+#include <utility>
 
 
 RequestQueue::RequestQueue(const SearchServer& search_server)
-        : search_server_(search_server) {
+        : RequestQueue(search_server, GetSteadyClockMinute) {
 }
 
-std::vector<Document> RequestQueue::AddFindRequest(const std::string& raw_query, DocumentStatus status) {
-        return AddFindRequest(
-            raw_query, [status](int document_id, DocumentStatus document_status, int rating) {
-                return document_status == status;
-            });
+RequestQueue::RequestQueue(const SearchServer& search_server, MinuteClock minute_clock)
+        : search_server_(search_server)
+        , minute_clock_(std::move(minute_clock)) {
 }
 
-std::vector<Document> RequestQueue::AddFindRequest(const std::string& raw_query) {
+std::vector<Document> RequestQueue::AddFindRequest(std::string_view raw_query, DocumentStatus status) {
+    return RecordRequest([&] {
+        return search_server_.FindTopDocuments(raw_query, status);
+    });
+}
+
+std::vector<Document> RequestQueue::AddFindRequest(std::string_view raw_query) {
     return AddFindRequest(raw_query,
                           DocumentStatus::ACTUAL);
 }
 
 int RequestQueue::GetNoResultRequests() const {
-    return no_result_requests_;
-}
\ No newline at end of file
+    return static_cast<int>(GetStats().no_result_request_count);
+}
+
+RequestStats::Snapshot RequestQueue::GetStats() const {
+    return stats_.GetSnapshot(minute_clock_());
+}
+
+int64_t RequestQueue::GetSteadyClockMinute() {
+    const auto time = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::minutes>(time).count();
+}
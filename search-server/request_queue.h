@@ -1,49 +1,54 @@
 #pragma once
 
 #include "search_server.h"
-#include <deque>
+#include "request_stats.h"
+#include <chrono>
+#include <cstdint>
+#include <functional>
 #include <vector>
 #include <string>
+#include <string_view>
 
+// Выполняет запросы к серверу и ведёт по ним статистику за последние сутки.
+// Запросы можно отправлять из нескольких потоков одновременно
 class RequestQueue {
 public:
+    // Текущая минута, не меньше нуля. По умолчанию минуты отсчитываются по steady_clock,
+    // другие часы нужны, например, чтобы воспроизвести смену суток без ожидания
+    using MinuteClock = std::function<int64_t()>;
+
     explicit RequestQueue(const SearchServer& search_server);
+
+    RequestQueue(const SearchServer& search_server, MinuteClock minute_clock);
     
     template <typename DocumentPredicate>
-    std::vector<Document> AddFindRequest(const std::string& raw_query, DocumentPredicate document_predicate) {
-        std::vector<Document> results = search_server_.FindTopDocuments(raw_query, document_predicate);
-        QueryResult query_result;
-        query_result.number_of_results = results.size();
-        if (query_result.number_of_results == 0){
-            no_result_requests_ += 1;
-        }
-        for(int i = 0; i < query_result.number_of_results; ++i){
-            current_time_ += 1;
-        }
-        query_result.current_time = current_time_;
-        requests_.push_back(query_result);
-        if (requests_.size() == min_in_day_ + 1){
-            if (requests_.front().number_of_results == 0){
-                no_result_requests_ -= 1;
-            }
-            requests_.pop_front();
-        }
-        return results;
+    std::vector<Document> AddFindRequest(std::string_view raw_query, DocumentPredicate document_predicate) {
+        return RecordRequest([&] {
+            return search_server_.FindTopDocuments(raw_query, document_predicate);
+        });
     }
     
-    std::vector<Document> AddFindRequest(const std::string& raw_query, DocumentStatus status);
+    std::vector<Document> AddFindRequest(std::string_view raw_query, DocumentStatus status);
     
-    std::vector<Document> AddFindRequest(const std::string& raw_query);
+    std::vector<Document> AddFindRequest(std::string_view raw_query);
     
+    // Запросы без результатов за последние сутки
     int GetNoResultRequests() const;
+
+    RequestStats::Snapshot GetStats() const;
 private:
-    int no_result_requests_ = 0;
-    int current_time_ = 0;
-    struct QueryResult {
-        int current_time = 0;
-        int number_of_results = 0;
-    };
-    std::deque<QueryResult> requests_;
-    const static int min_in_day_ = 1440;
     const SearchServer& search_server_;
-};
\ No newline at end of file
+    MinuteClock minute_clock_;
+    RequestStats stats_;
+
+    template <typename Search>
+    std::vector<Document> RecordRequest(Search search) {
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<Document> results = search();
+        const auto finish = std::chrono::steady_clock::now();
+        stats_.Record(minute_clock_(), results.size(), finish - start);
+        return results;
+    }
+
+    static int64_t GetSteadyClockMinute();
+};
@@ -0,0 +1,128 @@
+#include "request_stats.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+// Разметка слова состояния ячейки: младшие биты — число писателей, затем
+// признак обнуления, в старших битах минута плюс один (0 — ячейка пуста)
+const uint64_t WRITER_BITS = 24;
+const uint64_t WRITER_MASK = (uint64_t{1} << WRITER_BITS) - 1;
+const uint64_t RESETTING = uint64_t{1} << WRITER_BITS;
+const uint64_t MINUTE_SHIFT = WRITER_BITS + 1;
+
+uint64_t MakeState(int64_t minute, uint64_t flags) {
+    return (static_cast<uint64_t>(minute) + 1) << MINUTE_SHIFT | flags;
+}
+
+int64_t GetStateMinute(uint64_t state) {
+    return static_cast<int64_t>(state >> MINUTE_SHIFT) - 1;
+}
+
+} // namespace
+
+RequestStats::RequestStats()
+    : buckets_(WINDOW_MINUTES) {
+}
+
+void RequestStats::Record(int64_t minute, size_t result_count, std::chrono::nanoseconds latency) {
+    // Номер ячейки и слово состояния рассчитаны только на неотрицательные минуты
+    if (minute < 0) {
+        throw std::invalid_argument("Minute must be non-negative");
+    }
+    MinuteBucket* bucket = AcquireBucket(minute);
+    if (bucket == nullptr) {
+        return;
+    }
+    bucket->request_count.fetch_add(1, std::memory_order_relaxed);
+    if (result_count == 0) {
+        bucket->no_result_request_count.fetch_add(1, std::memory_order_relaxed);
+    }
+    bucket->latency_histogram[GetLatencyBucket(latency)].fetch_add(1, std::memory_order_relaxed);
+    ReleaseBucket(*bucket);
+}
+
+RequestStats::Snapshot RequestStats::GetSnapshot(int64_t minute) const {
+    Snapshot snapshot;
+    for (const MinuteBucket& bucket : buckets_) {
+        // Если ячейка перешла к другой минуте, пока читались счётчики, её читаем заново
+        while (true) {
+            const uint64_t state = bucket.state.load(std::memory_order_acquire);
+            const int64_t bucket_minute = GetStateMinute(state);
+            if ((state & RESETTING) != 0 || bucket_minute > minute
+                || bucket_minute <= minute - static_cast<int64_t>(WINDOW_MINUTES)) {
+                break;
+            }
+            // Обнуление пишется с release: прочитав ноль, поток увидит и смену минуты
+            Snapshot bucket_snapshot;
+            bucket_snapshot.request_count = bucket.request_count.load(std::memory_order_acquire);
+            bucket_snapshot.no_result_request_count = bucket.no_result_request_count.load(std::memory_order_acquire);
+            for (size_t i = 0; i < LATENCY_BUCKET_COUNT; ++i) {
+                bucket_snapshot.latency_histogram[i] = bucket.latency_histogram[i].load(std::memory_order_acquire);
+            }
+            if ((bucket.state.load(std::memory_order_relaxed) >> MINUTE_SHIFT) != (state >> MINUTE_SHIFT)) {
+                continue;
+            }
+            snapshot.request_count += bucket_snapshot.request_count;
+            snapshot.no_result_request_count += bucket_snapshot.no_result_request_count;
+            for (size_t i = 0; i < LATENCY_BUCKET_COUNT; ++i) {
+                snapshot.latency_histogram[i] += bucket_snapshot.latency_histogram[i];
+            }
+            break;
+        }
+    }
+    return snapshot;
+}
+
+size_t RequestStats::GetLatencyBucket(std::chrono::nanoseconds latency) {
+    const auto microseconds = std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+    size_t bucket = 0;
+    for (auto value = microseconds; value > 0 && bucket + 1 < LATENCY_BUCKET_COUNT; value >>= 1) {
+        ++bucket;
+    }
+    return bucket;
+}
+
+RequestStats::MinuteBucket* RequestStats::AcquireBucket(int64_t minute) {
+    MinuteBucket& bucket = buckets_[minute % static_cast<int64_t>(WINDOW_MINUTES)];
+    uint64_t state = bucket.state.load(std::memory_order_acquire);
+    while (true) {
+        const int64_t bucket_minute = GetStateMinute(state);
+        if (bucket_minute > minute) {
+            return nullptr;
+        }
+        if (bucket_minute == minute && (state & RESETTING) == 0) {
+            if (bucket.state.compare_exchange_weak(state, state + 1, std::memory_order_acquire)) {
+                return &bucket;
+            }
+            continue;
+        }
+        if (bucket_minute < minute && (state & WRITER_MASK) == 0) {
+            // Ячейку занимает прошлая минута без писателей: её перехватывает и обнуляет этот поток
+            if (bucket.state.compare_exchange_weak(state, MakeState(minute, RESETTING | 1),
+                                                   std::memory_order_acquire)) {
+                bucket.request_count.store(0, std::memory_order_release);
+                bucket.no_result_request_count.store(0, std::memory_order_release);
+                for (auto& counter : bucket.latency_histogram) {
+                    counter.store(0, std::memory_order_release);
+                }
+                bucket.state.store(MakeState(minute, 1), std::memory_order_release);
+                return &bucket;
+            }
+            continue;
+        }
+        // Ячейку обнуляют или дописывают писатели прошлой минуты: это несколько
+        // атомарных сложений, поэтому ожидание короткое
+        std::this_thread::yield();
+        state = bucket.state.load(std::memory_order_acquire);
+    }
+}
+
+void RequestStats::ReleaseBucket(MinuteBucket& bucket) {
+    bucket.state.fetch_sub(1, std::memory_order_release);
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Статистика запросов за скользящее окно в WINDOW_MINUTES минут. Каждой минуте
+// соответствует ячейка кольцевого буфера с фиксированным набором счётчиков,
+// поэтому память не зависит от числа запросов. Счётчики атомарные, и записывать
+// в статистику можно из многих потоков без блокировок
+class RequestStats {
+public:
+    static const size_t WINDOW_MINUTES = 1440;
+    // Корзина i гистограммы считает запросы с задержкой меньше 2^i мкс,
+    // последняя корзина — все более долгие
+    static const size_t LATENCY_BUCKET_COUNT = 24;
+
+    struct Snapshot {
+        uint64_t request_count = 0;
+        uint64_t no_result_request_count = 0;
+        std::array<uint64_t, LATENCY_BUCKET_COUNT> latency_histogram{};
+    };
+
+    RequestStats();
+
+    // Запись, опоздавшая больше чем на окно, отбрасывается; остальные
+    // учитываются точно, в том числе во время перехода ячейки к новой минуте.
+    // Минуты отсчитываются от нуля, отрицательная минута — std::invalid_argument
+    void Record(int64_t minute, size_t result_count, std::chrono::nanoseconds latency);
+
+    // Сумма по минутам (minute - WINDOW_MINUTES, minute]
+    Snapshot GetSnapshot(int64_t minute) const;
+
+    static size_t GetLatencyBucket(std::chrono::nanoseconds latency);
+
+private:
+    // Состояние ячейки в одном слове: минута, признак обнуления и число
+    // писателей, которые сейчас увеличивают её счётчики. Ячейка переходит к
+    // новой минуте только без писателей старой, а пока она обнуляется,
+    // писатели новой минуты ждут, поэтому ни одна запись не теряется
+    struct MinuteBucket {
+        std::atomic<uint64_t> state{0};
+        std::atomic<uint64_t> request_count{0};
+        std::atomic<uint64_t> no_result_request_count{0};
+        std::array<std::atomic<uint64_t>, LATENCY_BUCKET_COUNT> latency_histogram{};
+    };
+
+    std::vector<MinuteBucket> buckets_;
+
+    // Ячейка минуты с учтённым писателем или nullptr, если её уже заняла более
+    // поздняя минута. Писатель снимает себя со счёта в ReleaseBucket
+    MinuteBucket* AcquireBucket(int64_t minute);
+
+    static void ReleaseBucket(MinuteBucket& bucket);
+};
@@ -1,97 +1,430 @@
 #include "search_server.h"
 #include "document.h"
 #include "string_processing.h"
+#include "index_file.h"
+#include "compressed_postings.h"
+#include "mapped_search_server.h"
 #include <string>
+#include <string_view>
 #include <vector>
-#include <set>
 #include <map>
+#include <unordered_map>
+#include <unordered_set>
 #include <deque>
 #include <algorithm>
 #include <stdexcept>
 #include <cmath>
 #include <numeric>
+#include <utility>
+#include <exception>
+#include <limits>
+#include <iterator>
+#include <cstring>
+#include <fstream>
+#include <memory>
+
+namespace {
+
+template <typename PostingIterator>
+PostingIterator LowerBoundByDocument(PostingIterator first, PostingIterator last, uint32_t document_ordinal) {
+    return std::lower_bound(first, last, document_ordinal,
+        [](const auto& posting, uint32_t ordinal) {
+            return posting.document_ordinal < ordinal;
+        });
+}
+
+template <typename Item>
+void WriteItems(std::ofstream& output, const std::vector<Item>& items) {
+    output.write(reinterpret_cast<const char*>(items.data()), items.size() * sizeof(Item));
+}
+
+} // namespace
 
 SearchServer::SearchServer(const std::string& stop_words_text)
+        : SearchServer(std::string_view(stop_words_text)) {
+    }
+
+SearchServer::SearchServer(std::string_view stop_words_text)
         : SearchServer(
             SplitIntoWords(stop_words_text)){
     }
 
-void SearchServer::AddDocument(int document_id, const std::string& document, DocumentStatus status,
+void SearchServer::AddDocument(int document_id, std::string_view document, DocumentStatus status,
                  const std::vector<int>& ratings) {
-    if ((document_id < 0) || (documents_.count(document_id) > 0)) {
+    if ((document_id < 0) || (document_ordinals_.count(document_id) > 0)) {
         throw std::invalid_argument("Invalid document_id");
     }
+    // Слова проверяются до изменения индекса, дальше документ обрабатывается по номерам термов
     const auto words = SplitIntoWordsNoStop(document);
-
-    const double inv_word_count = 1.0 / words.size();
-    for (const std::string& word : words) {
-        word_to_document_freqs_[word][document_id] += inv_word_count;
+    std::vector<uint32_t> term_ids(words.size());
+    std::transform(words.begin(), words.end(), term_ids.begin(),
+        [this](const HashedWord& word) {
+            return FindOrAddTerm(word);
+        });
+    TermFreqs document_terms = CountTermFreqs(std::move(term_ids));
+    // Новый документ получает наибольший номер, и его постинг всегда дописывается в конец списка
+    const auto document_ordinal = static_cast<uint32_t>(document_ids_.size());
+    for (const auto& [term_id, term_freq] : document_terms) {
+        WordEntry& word_entry = terms_[term_id];
+        word_entry.max_term_freq = std::max(word_entry.max_term_freq, term_freq);
+        word_entry.postings.push_back({document_ordinal, term_freq});
     }
-    documents_.emplace(document_id, DocumentData{ComputeAverageRating(ratings), status});
-    document_ids_.push_back(document_id);
+    RegisterDocument(document_id, status, ratings, static_cast<uint32_t>(words.size()));
+    document_terms_.push_back(std::move(document_terms));
+    ++generation_;
 }
 
-std::vector<Document> SearchServer::FindTopDocuments(const std::string& raw_query, DocumentStatus status) const {
-    return FindTopDocuments(
-        raw_query, [status](int document_id, DocumentStatus document_status, int rating) {
-            return document_status == status;
-        });
+void SearchServer::AddDocuments(const std::vector<NewDocument>& documents) {
+    AddDocuments(std::execution::seq, documents);
 }
 
-std::vector<Document> SearchServer::FindTopDocuments(const std::string& raw_query) const {
+std::vector<Document> SearchServer::FindTopDocuments(std::string_view raw_query, DocumentStatus status,
+                                                    size_t top_k) const {
+    return FindTopDocuments(std::execution::seq, raw_query, status, top_k);
+}
+
+std::vector<Document> SearchServer::FindTopDocuments(std::string_view raw_query) const {
     return FindTopDocuments(raw_query, DocumentStatus::ACTUAL);
 }
 
+std::vector<Document> SearchServer::FindTopDocuments(const Query& query, DocumentStatus status,
+                                                     size_t top_k) const {
+    return FindTopDocuments(std::execution::seq, query, status, top_k);
+}
+
 int SearchServer::GetDocumentCount() const {
-    return documents_.size();
+    return document_ids_.size();
+}
+
+uint64_t SearchServer::GetGeneration() const {
+    return generation_;
+}
+
+Query SearchServer::NormalizeQuery(std::string_view raw_query) const {
+    return ParseQuery(raw_query, stop_words_);
 }
 
 int SearchServer::GetDocumentId(int index) const {
-    return document_ids_.at(index);
+    if (index < 0 || index >= GetDocumentCount()) {
+        throw std::out_of_range("Invalid document index");
+    }
+    return document_ids_[index];
 }
 
-std::tuple<std::vector<std::string>, DocumentStatus> SearchServer::MatchDocument(const std::string& raw_query, int document_id) const {
-    const auto query = ParseQuery(raw_query);
+std::vector<int>::const_iterator SearchServer::begin() const {
+    return document_ids_.begin();
+}
 
-    std::vector<std::string> matched_words;
-    for (const std::string& word : query.plus_words) {
-        if (word_to_document_freqs_.count(word) == 0) {
-            continue;
+std::vector<int>::const_iterator SearchServer::end() const {
+    return document_ids_.end();
+}
+
+std::map<std::string_view, double> SearchServer::GetWordFrequencies(int document_id) const {
+    std::map<std::string_view, double> word_freqs;
+    const uint32_t* document_ordinal = FindDocumentOrdinal(document_id);
+    if (document_ordinal == nullptr) {
+        return word_freqs;
+    }
+    for (const auto& [term_id, term_freq] : document_terms_[*document_ordinal]) {
+        word_freqs.emplace(words_[term_id], term_freq);
+    }
+    return word_freqs;
+}
+
+void SearchServer::RemoveDocument(int document_id) {
+    RemoveDocument(std::execution::seq, document_id);
+}
+
+void SearchServer::Save(const std::string& path, index_file::PostingFormat posting_format) const {
+    // В файле документы лежат по возрастанию id, а не в порядке внутренних номеров
+    std::vector<uint32_t> ordinals_by_id(document_ids_.size());
+    std::iota(ordinals_by_id.begin(), ordinals_by_id.end(), 0);
+    std::sort(ordinals_by_id.begin(), ordinals_by_id.end(),
+        [this](uint32_t lhs, uint32_t rhs) {
+            return document_ids_[lhs] < document_ids_[rhs];
+        });
+    std::vector<index_file::Document> file_documents;
+    file_documents.reserve(ordinals_by_id.size());
+    std::vector<uint32_t> document_indexes(ordinals_by_id.size());
+    for (uint32_t document_ordinal : ordinals_by_id) {
+        document_indexes[document_ordinal] = static_cast<uint32_t>(file_documents.size());
+        file_documents.push_back({document_ids_[document_ordinal], document_ratings_[document_ordinal],
+                                  static_cast<int32_t>(document_statuses_[document_ordinal]),
+                                  document_word_counts_[document_ordinal]});
+    }
+
+    std::vector<std::pair<std::string_view, const WordEntry*>> words;
+    for (uint32_t term_id = 0; term_id < terms_.size(); ++term_id) {
+        if (!terms_[term_id].postings.empty()) {
+            words.emplace_back(words_[term_id], &terms_[term_id]);
         }
-        if (word_to_document_freqs_.at(word).count(document_id)) {
-            matched_words.push_back(word);
+    }
+    std::sort(words.begin(), words.end(),
+        [](const auto& lhs, const auto& rhs) {
+            return lhs.first < rhs.first;
+        });
+
+    std::string strings;
+    std::vector<index_file::Word> file_words;
+    file_words.reserve(words.size());
+    std::vector<index_file::Posting> file_postings;
+    std::vector<uint32_t> file_compressed_postings;
+    std::vector<std::pair<uint32_t, double>> postings;
+    std::vector<std::pair<uint32_t, uint32_t>> occurrence_counts;
+    for (const auto& [word, word_entry] : words) {
+        postings.clear();
+        for (const auto& [document_ordinal, term_freq] : word_entry->postings) {
+            postings.emplace_back(document_indexes[document_ordinal], term_freq);
+        }
+        std::sort(postings.begin(), postings.end());
+        const bool compressed = posting_format == index_file::PostingFormat::COMPRESSED;
+        file_words.push_back({strings.size(), compressed ? file_compressed_postings.size() : file_postings.size(),
+                              static_cast<uint32_t>(word.size()), static_cast<uint32_t>(postings.size()),
+                              ComputeWordInverseDocumentFreq(*word_entry)});
+        strings += word;
+        if (compressed) {
+            // Частота получена как число вхождений, умноженное на 1.0 / число слов,
+            // поэтому число вхождений восстанавливается точно
+            occurrence_counts.clear();
+            for (const auto& [document_index, term_freq] : postings) {
+                const double word_count = file_documents[document_index].word_count;
+                occurrence_counts.emplace_back(document_index, static_cast<uint32_t>(std::lround(term_freq * word_count)));
+            }
+            compressed_postings::Encode(occurrence_counts, file_compressed_postings);
+        } else {
+            for (const auto& [document_index, term_freq] : postings) {
+                file_postings.push_back({document_index, 0, term_freq});
+            }
         }
     }
-    for (const std::string& word : query.minus_words) {
-        if (word_to_document_freqs_.count(word) == 0) {
-            continue;
+    // Секция постингов должна оставаться выровненной по 8 байтам
+    if (file_compressed_postings.size() % 2 != 0) {
+        file_compressed_postings.push_back(0);
+    }
+    std::vector<index_file::Word> file_stop_words;
+    for (const std::string& stop_word : stop_words_.GetWords()) {
+        file_stop_words.push_back({strings.size(), 0, static_cast<uint32_t>(stop_word.size()), 0, 0.0});
+        strings += stop_word;
+    }
+
+    index_file::Header header{};
+    std::memcpy(header.magic, index_file::MAGIC, sizeof(header.magic));
+    header.version = index_file::VERSION;
+    header.posting_format = posting_format;
+    header.document_count = file_documents.size();
+    header.word_count = file_words.size();
+    header.stop_word_count = file_stop_words.size();
+    header.posting_count = file_postings.size() + file_compressed_postings.size();
+    header.strings_size = strings.size();
+    header.documents_offset = sizeof(header);
+    header.words_offset = header.documents_offset + file_documents.size() * sizeof(index_file::Document);
+    header.stop_words_offset = header.words_offset + file_words.size() * sizeof(index_file::Word);
+    header.postings_offset = header.stop_words_offset + file_stop_words.size() * sizeof(index_file::Word);
+    header.strings_offset = header.postings_offset + file_postings.size() * sizeof(index_file::Posting)
+        + file_compressed_postings.size() * sizeof(uint32_t);
+    header.file_size = header.strings_offset + strings.size();
+
+    std::ofstream output(path, std::ios::binary | std::ios::trunc);
+    if (!output) {
+        throw std::runtime_error("Cannot create index file " + path);
+    }
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    WriteItems(output, file_documents);
+    WriteItems(output, file_words);
+    WriteItems(output, file_stop_words);
+    WriteItems(output, file_postings);
+    WriteItems(output, file_compressed_postings);
+    output.write(strings.data(), strings.size());
+    if (!output) {
+        throw std::runtime_error("Cannot write index file " + path);
+    }
+}
+
+MappedSearchServer SearchServer::Open(const std::string& path) {
+    return MappedSearchServer(path);
+}
+
+std::tuple<std::vector<std::string_view>, DocumentStatus> SearchServer::MatchDocument(std::string_view raw_query, int document_id) const {
+    return MatchDocument(std::execution::seq, raw_query, document_id);
+}
+
+std::tuple<std::vector<std::string_view>, DocumentStatus> SearchServer::MatchDocument(const std::execution::sequenced_policy&,
+                                                                        std::string_view raw_query, int document_id) const {
+    const uint32_t* document_ordinal = FindDocumentOrdinal(document_id);
+    if (document_ordinal == nullptr) {
+        throw std::out_of_range("Invalid document_id");
+    }
+    const DocumentStatus status = document_statuses_[*document_ordinal];
+    const TermFreqs& document_terms = document_terms_[*document_ordinal];
+    const auto query = ParseQuery(raw_query, stop_words_);
+
+    // Минус-слово отбрасывает документ целиком, поэтому плюс-слова смотрим только после них
+    for (const HashedWord& word : query.minus_words) {
+        if (FindDocumentTerm(document_terms, word) != nullptr) {
+            return {std::vector<std::string_view>{}, status};
         }
-        if (word_to_document_freqs_.at(word).count(document_id)) {
-            matched_words.clear();
-            break;
+    }
+
+    std::vector<std::string_view> matched_words;
+    for (const HashedWord& word : query.plus_words) {
+        const uint32_t* term_id = FindDocumentTerm(document_terms, word);
+        if (term_id != nullptr) {
+            matched_words.push_back(words_[*term_id]);
         }
     }
-    return {matched_words, documents_.at(document_id).status};
+    return {matched_words, status};
 }
 
-bool SearchServer::IsStopWord(const std::string& word) const {
-    return stop_words_.count(word) > 0;
+std::tuple<std::vector<std::string_view>, DocumentStatus> SearchServer::MatchDocument(const std::execution::parallel_policy&,
+                                                                        std::string_view raw_query, int document_id) const {
+    const uint32_t* document_ordinal = FindDocumentOrdinal(document_id);
+    if (document_ordinal == nullptr) {
+        throw std::out_of_range("Invalid document_id");
+    }
+    const DocumentStatus status = document_statuses_[*document_ordinal];
+    const TermFreqs& document_terms = document_terms_[*document_ordinal];
+    // Повторы убираем уже среди найденных слов, их обычно намного меньше, чем слов в запросе
+    const auto query = ParseQuery(raw_query, stop_words_, false);
+
+    if (std::any_of(std::execution::par, query.minus_words.begin(), query.minus_words.end(),
+            [this, &document_terms](const HashedWord& word) {
+                return FindDocumentTerm(document_terms, word) != nullptr;
+            })) {
+        return {std::vector<std::string_view>{}, status};
+    }
+
+    std::vector<std::string_view> matched_words(query.plus_words.size());
+    std::transform(std::execution::par,
+        query.plus_words.begin(), query.plus_words.end(), matched_words.begin(),
+        [this, &document_terms](const HashedWord& word) {
+            const uint32_t* term_id = FindDocumentTerm(document_terms, word);
+            return term_id != nullptr ? std::string_view(words_[*term_id]) : std::string_view{};
+        });
+    matched_words.erase(std::remove(matched_words.begin(), matched_words.end(), std::string_view{}),
+                        matched_words.end());
+    RemoveDuplicateWords(matched_words);
+    return {matched_words, status};
 }
 
-bool SearchServer::IsValidWord(const std::string& word) {
-    return none_of(word.begin(), word.end(), [](char c) {
-        return c >= '\0' && c < ' ';
-    });
+void SearchServer::ValidateNewDocumentIds(const std::vector<NewDocument>& documents) const {
+    std::unordered_set<int> new_document_ids;
+    for (const NewDocument& document : documents) {
+        if (document.id < 0 || document_ordinals_.count(document.id) > 0
+            || !new_document_ids.insert(document.id).second) {
+            throw std::invalid_argument("Invalid document_id");
+        }
+    }
+}
+
+SearchServer::PartialIndex SearchServer::BuildPartialIndex(const NewDocument* first, const NewDocument* last,
+                                                         uint32_t first_ordinal) const {
+    PartialIndex partial_index;
+    try {
+        std::unordered_map<HashedWord, uint32_t, HashedWordHasher> word_to_local_id;
+        partial_index.document_terms.reserve(last - first);
+        partial_index.word_counts.reserve(last - first);
+        uint32_t document_ordinal = first_ordinal;
+        for (const NewDocument* document = first; document != last; ++document, ++document_ordinal) {
+            const auto words = SplitIntoWordsNoStop(document->text);
+            std::vector<uint32_t> local_ids(words.size());
+            std::transform(words.begin(), words.end(), local_ids.begin(),
+                [&](const HashedWord& word) {
+                    const auto local_id = static_cast<uint32_t>(partial_index.words.size());
+                    const auto [word_it, inserted] = word_to_local_id.emplace(word, local_id);
+                    if (inserted) {
+                        partial_index.words.push_back(word);
+                        partial_index.postings.emplace_back();
+                    }
+                    return word_it->second;
+                });
+            TermFreqs document_terms = CountTermFreqs(std::move(local_ids));
+            for (const auto& [local_id, term_freq] : document_terms) {
+                partial_index.postings[local_id].push_back({document_ordinal, term_freq});
+            }
+            partial_index.document_terms.push_back(std::move(document_terms));
+            partial_index.word_counts.push_back(static_cast<uint32_t>(words.size()));
+        }
+    } catch (...) {
+        // Исключение не должно покидать параллельный алгоритм, его перебросит AddDocuments
+        partial_index.error = std::current_exception();
+    }
+    return partial_index;
 }
 
-std::vector<std::string> SearchServer::SplitIntoWordsNoStop(const std::string& text) const {
-    std::vector<std::string> words;
-    for (const std::string& word : SplitIntoWords(text)) {
-        if (!IsValidWord(word)) {
-            throw std::invalid_argument("Word " + word + " is invalid");
+void SearchServer::MergePartialIndex(PartialIndex& partial_index) {
+    partial_index.term_ids.resize(partial_index.words.size());
+    for (uint32_t local_id = 0; local_id < partial_index.words.size(); ++local_id) {
+        const uint32_t term_id = FindOrAddTerm(partial_index.words[local_id]);
+        partial_index.term_ids[local_id] = term_id;
+        const PostingList& postings = partial_index.postings[local_id];
+        WordEntry& word_entry = terms_[term_id];
+        for (const Posting& posting : postings) {
+            word_entry.max_term_freq = std::max(word_entry.max_term_freq, posting.term_freq);
         }
-        if (!IsStopWord(word)) {
-            words.push_back(word);
+        word_entry.postings.insert(word_entry.postings.end(), postings.begin(), postings.end());
+    }
+}
+
+SearchServer::TermFreqs SearchServer::TranslateTerms(const TermFreqs& document_terms,
+                                                    const std::vector<uint32_t>& term_ids) {
+    TermFreqs translated_terms(document_terms.size());
+    std::transform(document_terms.begin(), document_terms.end(), translated_terms.begin(),
+        [&term_ids](const TermFreq& term) {
+            return TermFreq{term_ids[term.term_id], term.term_freq};
+        });
+    std::sort(translated_terms.begin(), translated_terms.end(),
+        [](const TermFreq& lhs, const TermFreq& rhs) {
+            return lhs.term_id < rhs.term_id;
+        });
+    return translated_terms;
+}
+
+SearchServer::TermFreqs SearchServer::CountTermFreqs(std::vector<uint32_t> term_ids) {
+    // После сортировки повторы терма идут подряд, и в каждый список постингов
+    // попадает ровно по одному элементу на документ
+    std::sort(term_ids.begin(), term_ids.end());
+    const double inv_word_count = 1.0 / term_ids.size();
+    TermFreqs term_freqs;
+    for (auto it = term_ids.begin(); it != term_ids.end();) {
+        const auto run_end = std::upper_bound(it, term_ids.end(), *it);
+        term_freqs.push_back({*it, (run_end - it) * inv_word_count});
+        it = run_end;
+    }
+    return term_freqs;
+}
+
+uint32_t SearchServer::FindOrAddTerm(const HashedWord& word) {
+    const auto it = word_to_term_id_.find(word);
+    if (it != word_to_term_id_.end()) {
+        return it->second;
+    }
+    const auto term_id = static_cast<uint32_t>(terms_.size());
+    word_to_term_id_.emplace(HashedWord{words_.emplace_back(word.word), word.hash}, term_id);
+    terms_.emplace_back();
+    return term_id;
+}
+
+void SearchServer::RegisterDocument(int document_id, DocumentStatus status, const std::vector<int>& ratings,
+                                    uint32_t word_count) {
+    const auto document_ordinal = static_cast<uint32_t>(document_ids_.size());
+    document_ordinals_.emplace(document_id, document_ordinal);
+    document_ids_.push_back(document_id);
+    document_ratings_.push_back(ComputeAverageRating(ratings));
+    document_statuses_.push_back(status);
+    status_to_documents_[status].Add(document_ordinal);
+    document_word_counts_.push_back(word_count);
+}
+
+bool SearchServer::IsStopWord(const HashedWord& word) const {
+    return stop_words_.Contains(word);
+}
+
+std::vector<HashedWord> SearchServer::SplitIntoWordsNoStop(std::string_view text) const {
+    std::vector<HashedWord> words;
+    for (std::string_view word : SplitIntoValidWords(text)) {
+        const HashedWord hashed_word = HashWord(word);
+        if (!IsStopWord(hashed_word)) {
+            words.push_back(hashed_word);
         }
     }
     return words;
@@ -105,38 +438,179 @@ int SearchServer::SearchServer::ComputeAverageRating(const std::vector<int>& rat
         return rating_sum / static_cast<int>(ratings.size()); 
 }
 
-SearchServer::QueryWord SearchServer::ParseQueryWord(const std::string& text) const {
-    if (text.empty()) {
-        throw std::invalid_argument("Query word is empty");
+std::vector<Document> SearchServer::BuildMatchedDocuments(const std::map<uint32_t, double>& document_to_relevance) const {
+    std::vector<Document> matched_documents;
+    matched_documents.reserve(document_to_relevance.size());
+    for (const auto& [document_ordinal, relevance] : document_to_relevance) {
+        matched_documents.push_back(
+            {document_ids_[document_ordinal], relevance, document_ratings_[document_ordinal]});
     }
-    std::string word = text;
-    bool is_minus = false;
-    if (word[0] == '-') {
-        is_minus = true;
-        word = word.substr(1);
+    return matched_documents;
+}
+
+std::vector<Document> SearchServer::BuildMatchedDocuments(const RelevanceAccumulator& document_to_relevance) const {
+    std::vector<Document> matched_documents;
+    matched_documents.reserve(document_to_relevance.GetTouchedCount());
+    document_to_relevance.ForEach([this, &matched_documents](uint32_t document_ordinal, double relevance) {
+        matched_documents.push_back(
+            {document_ids_[document_ordinal], relevance, document_ratings_[document_ordinal]});
+    });
+    return matched_documents;
+}
+
+SearchServer::ThreadAccumulatorLease::ThreadAccumulatorLease() {
+    ThreadAccumulator& thread_accumulator = GetThreadAccumulator();
+    if (thread_accumulator.in_use) {
+        nested_accumulator_ = std::make_unique<RelevanceAccumulator>();
+    } else {
+        thread_accumulator.in_use = true;
+        thread_accumulator_ = &thread_accumulator;
     }
-    if (word.empty() || word[0] == '-' || !IsValidWord(word)) {
-        throw std::invalid_argument("Query word " + text + " is invalid");
+}
+
+SearchServer::ThreadAccumulatorLease::~ThreadAccumulatorLease() {
+    if (thread_accumulator_ != nullptr) {
+        thread_accumulator_->in_use = false;
     }
+}
 
-    return {word, is_minus, IsStopWord(word)};
+RelevanceAccumulator& SearchServer::ThreadAccumulatorLease::Get() {
+    return thread_accumulator_ != nullptr ? thread_accumulator_->accumulator : *nested_accumulator_;
 }
 
-SearchServer::Query SearchServer::ParseQuery(const std::string& text) const {
-    Query result;
-    for (const std::string& word : SplitIntoWords(text)) {
-        const auto query_word = ParseQueryWord(word);
-        if (!query_word.is_stop) {
-            if (query_word.is_minus) {
-                result.minus_words.insert(query_word.data);
-            } else {
-                result.plus_words.insert(query_word.data);
-            }
+SearchServer::ThreadAccumulatorLease::ThreadAccumulator& SearchServer::ThreadAccumulatorLease::GetThreadAccumulator() {
+    thread_local ThreadAccumulator thread_accumulator;
+    return thread_accumulator;
+}
+
+SearchServer::CachedInverseDocumentFreq::CachedInverseDocumentFreq(const CachedInverseDocumentFreq& other)
+    : generation_(other.generation_.load(std::memory_order_acquire))
+    , value_(other.value_.load(std::memory_order_relaxed)) {
+}
+
+SearchServer::CachedInverseDocumentFreq& SearchServer::CachedInverseDocumentFreq::operator=(
+        const CachedInverseDocumentFreq& other) {
+    Set(other.generation_.load(std::memory_order_acquire), other.value_.load(std::memory_order_relaxed));
+    return *this;
+}
+
+bool SearchServer::CachedInverseDocumentFreq::TryGet(uint64_t generation, double& value) const {
+    if (generation_.load(std::memory_order_acquire) != generation) {
+        return false;
+    }
+    value = value_.load(std::memory_order_relaxed);
+    return true;
+}
+
+void SearchServer::CachedInverseDocumentFreq::Set(uint64_t generation, double value) const {
+    value_.store(value, std::memory_order_relaxed);
+    generation_.store(generation, std::memory_order_release);
+}
+
+double SearchServer::ComputeWordInverseDocumentFreq(const WordEntry& word_entry) const {
+    double inverse_document_freq;
+    if (!word_entry.inverse_document_freq.TryGet(generation_, inverse_document_freq)) {
+        inverse_document_freq = log(GetDocumentCount() * 1.0 / word_entry.postings.size());
+        word_entry.inverse_document_freq.Set(generation_, inverse_document_freq);
+    }
+    return inverse_document_freq;
+}
+
+const uint32_t* SearchServer::FindTermId(const HashedWord& word) const {
+    const auto it = word_to_term_id_.find(word);
+    if (it == word_to_term_id_.end()) {
+        return nullptr;
+    }
+    return &it->second;
+}
+
+const SearchServer::WordEntry* SearchServer::FindWord(const HashedWord& word) const {
+    const uint32_t* term_id = FindTermId(word);
+    // Пустые списки остаются после удаления документов, чтобы не терять номер терма
+    if (term_id == nullptr || terms_[*term_id].postings.empty()) {
+        return nullptr;
+    }
+    return &terms_[*term_id];
+}
+
+const uint32_t* SearchServer::FindDocumentTerm(const TermFreqs& document_terms, const HashedWord& word) const {
+    const uint32_t* term_id = FindTermId(word);
+    if (term_id == nullptr) {
+        return nullptr;
+    }
+    const auto it = std::lower_bound(document_terms.begin(), document_terms.end(), *term_id,
+        [](const TermFreq& term, uint32_t id) {
+            return term.term_id < id;
+        });
+    if (it == document_terms.end() || it->term_id != *term_id) {
+        return nullptr;
+    }
+    return term_id;
+}
+
+const uint32_t* SearchServer::FindDocumentOrdinal(int document_id) const {
+    const auto it = document_ordinals_.find(document_id);
+    if (it == document_ordinals_.end()) {
+        return nullptr;
+    }
+    return &it->second;
+}
+
+std::vector<SearchServer::PostingList*> SearchServer::GetDocumentPostings(uint32_t document_ordinal) {
+    const TermFreqs& document_terms = document_terms_[document_ordinal];
+    std::vector<PostingList*> document_postings(document_terms.size());
+    std::transform(document_terms.begin(), document_terms.end(), document_postings.begin(),
+        [this](const TermFreq& term) {
+            return &terms_[term.term_id].postings;
+        });
+    return document_postings;
+}
+
+SearchServer::PostingList::const_iterator SearchServer::SeekPosting(PostingList::const_iterator first,
+                                                                 PostingList::const_iterator last,
+                                                                 uint32_t document_ordinal) {
+    return LowerBoundByDocument(first, last, document_ordinal);
+}
+
+std::vector<uint32_t> SearchServer::CollectExcludedDocuments(const Query& query) const {
+    SEARCH_TRACE_PHASE(EXCLUDE);
+    std::vector<uint32_t> excluded_ordinals;
+    for (const HashedWord& word : query.minus_words) {
+        const WordEntry* word_entry = FindWord(word);
+        if (word_entry == nullptr) {
+            continue;
         }
+        // Каждый список уже отсортирован, поэтому достаточно слить его с накопленным
+        const auto middle = excluded_ordinals.size();
+        for (const auto& [document_ordinal, _] : word_entry->postings) {
+            excluded_ordinals.push_back(document_ordinal);
+        }
+        std::inplace_merge(excluded_ordinals.begin(), excluded_ordinals.begin() + middle, excluded_ordinals.end());
+    }
+    excluded_ordinals.erase(std::unique(excluded_ordinals.begin(), excluded_ordinals.end()),
+                            excluded_ordinals.end());
+    return excluded_ordinals;
+}
+
+SearchServer::ExclusionCursor::ExclusionCursor(const std::vector<uint32_t>& excluded_ordinals)
+    : current_(excluded_ordinals.begin())
+    , end_(excluded_ordinals.end()) {
+}
+
+bool SearchServer::ExclusionCursor::IsExcluded(uint32_t document_ordinal) {
+    current_ = std::lower_bound(current_, end_, document_ordinal);
+    return current_ != end_ && *current_ == document_ordinal;
+}
+
+void SearchServer::ErasePosting(PostingList& postings, uint32_t document_ordinal) {
+    const auto it = LowerBoundByDocument(postings.begin(), postings.end(), document_ordinal);
+    if (it != postings.end() && it->document_ordinal == document_ordinal) {
+        postings.erase(it);
     }
-    return result;
 }
 
-double SearchServer::ComputeWordInverseDocumentFreq(const std::string& word) const {
-    return log(GetDocumentCount() * 1.0 / word_to_document_freqs_.at(word).size());
+void SearchServer::MovePostingFromBack(PostingList& postings, uint32_t document_ordinal) {
+    const Posting posting{document_ordinal, postings.back().term_freq};
+    postings.pop_back();
+    postings.insert(LowerBoundByDocument(postings.begin(), postings.end(), document_ordinal), posting);
 }
\ No newline at end of file
@@ -1,17 +1,36 @@
 #pragma once
 #include "document.h"
 #include "string_processing.h"
+#include "query.h"
+#include "stop_word_table.h"
+#include "index_file.h"
+#include "concurrent_map.h"
+#include "document_bitmap.h"
+#include "relevance_accumulator.h"
+#include "search_trace.h"
 
 #include <string>
+#include <string_view>
 #include <vector>
-#include <set>
 #include <map>
+#include <unordered_map>
 #include <deque>
 #include <algorithm>
 #include <stdexcept>
 #include <cmath>
+#include <execution>
+#include <type_traits>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <queue>
+#include <exception>
+#include <memory>
 
-const int MAX_RESULT_DOCUMENT_COUNT = 5;
+// Количество документов в выдаче по умолчанию
+const size_t MAX_RESULT_DOCUMENT_COUNT = 5;
+
+class MappedSearchServer;
 
 class SearchServer {
 public:
@@ -19,114 +38,621 @@ public:
     explicit SearchServer(const StringContainer& stop_words)
         : stop_words_(MakeUniqueNonEmptyStrings(stop_words))  
     {
-        if (!all_of(stop_words_.begin(), stop_words_.end(), IsValidWord)) {
+        if (!all_of(stop_words_.GetWords().begin(), stop_words_.GetWords().end(), IsValidWord)) {
             throw std::invalid_argument("Some of stop words are invalid");
         }
     }
 
     explicit SearchServer(const std::string& stop_words_text);
 
-    void AddDocument(int document_id, const std::string& document, DocumentStatus status,
+    explicit SearchServer(std::string_view stop_words_text);
+
+    // Индекс ссылается на собственные строки через string_view, поэтому
+    // сервер можно перемещать, но не копировать
+    SearchServer(const SearchServer&) = delete;
+    SearchServer& operator=(const SearchServer&) = delete;
+    SearchServer(SearchServer&&) = default;
+    SearchServer& operator=(SearchServer&&) = default;
+
+    void AddDocument(int document_id, std::string_view document, DocumentStatus status,
                      const std::vector<int>& ratings);
 
-    template <typename DocumentPredicate>
-    std::vector<Document> FindTopDocuments(const std::string& raw_query,
-                                      DocumentPredicate document_predicate) const {
-        const auto query = ParseQuery(raw_query);
+    // Пакетное добавление. Документы разбиваются на части, каждая часть разбирается
+    // в отдельный небольшой индекс (параллельно при параллельной политике), затем
+    // индексы частей по очереди дописываются в общий. Если какой-то документ
+    // некорректен, исключение выбрасывается до изменения индекса.
+    // Большой корпус стоит подавать пакетами: тексты пакета должны жить до конца вызова
+    template <typename ExecutionPolicy>
+    void AddDocuments(ExecutionPolicy&& policy, const std::vector<NewDocument>& documents) {
+        ValidateNewDocumentIds(documents);
+        const auto first_ordinal = static_cast<uint32_t>(document_ids_.size());
+        std::vector<size_t> chunk_starts;
+        for (size_t start = 0; start < documents.size(); start += ADD_DOCUMENTS_CHUNK_SIZE) {
+            chunk_starts.push_back(start);
+        }
 
-        auto matched_documents = FindAllDocuments(query, document_predicate);
+        std::vector<PartialIndex> partial_indexes(chunk_starts.size());
+        std::transform(policy, chunk_starts.begin(), chunk_starts.end(), partial_indexes.begin(),
+            [&](size_t start) {
+                const size_t finish = std::min(start + ADD_DOCUMENTS_CHUNK_SIZE, documents.size());
+                return BuildPartialIndex(documents.data() + start, documents.data() + finish,
+                                         first_ordinal + static_cast<uint32_t>(start));
+            });
+        for (const PartialIndex& partial_index : partial_indexes) {
+            if (partial_index.error) {
+                std::rethrow_exception(partial_index.error);
+            }
+        }
 
-        std::sort(matched_documents.begin(), matched_documents.end(),
-             [](const Document& lhs, const Document& rhs) {
-                 if (std::abs(lhs.relevance - rhs.relevance) < std::numeric_limits<double>::epsilon()) {
-                     return lhs.rating > rhs.rating;
-                 } else {
-                     return lhs.relevance > rhs.relevance;
-                 }
-             });
-        if (matched_documents.size() > MAX_RESULT_DOCUMENT_COUNT) {
-            matched_documents.resize(MAX_RESULT_DOCUMENT_COUNT);
+        // Номера частей растут, поэтому их постинги дописываются в конец списков без сортировки
+        for (PartialIndex& partial_index : partial_indexes) {
+            MergePartialIndex(partial_index);
+        }
+        for (size_t i = 0; i < documents.size(); ++i) {
+            const PartialIndex& partial_index = partial_indexes[i / ADD_DOCUMENTS_CHUNK_SIZE];
+            RegisterDocument(documents[i].id, documents[i].status, documents[i].ratings,
+                             partial_index.word_counts[i % ADD_DOCUMENTS_CHUNK_SIZE]);
         }
+        // Все слова уже в индексе, и термы документов переводятся с номеров
+        // части на номера индекса без обращений к словарю
+        document_terms_.resize(document_ids_.size());
+        std::for_each(policy, chunk_starts.begin(), chunk_starts.end(),
+            [&](size_t start) {
+                const PartialIndex& partial_index = partial_indexes[start / ADD_DOCUMENTS_CHUNK_SIZE];
+                for (size_t i = 0; i < partial_index.document_terms.size(); ++i) {
+                    document_terms_[first_ordinal + start + i] =
+                        TranslateTerms(partial_index.document_terms[i], partial_index.term_ids);
+                }
+            });
+        ++generation_;
+    }
 
-        return matched_documents;
+    void AddDocuments(const std::vector<NewDocument>& documents);
+
+    template <typename ExecutionPolicy, typename DocumentPredicate>
+    std::vector<Document> FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query,
+                                      DocumentPredicate document_predicate,
+                                      size_t top_k = MAX_RESULT_DOCUMENT_COUNT) const {
+        Query query;
+        {
+            SEARCH_TRACE_PHASE(PARSE);
+            query = ParseQuery(raw_query, stop_words_);
+        }
+        return FindTopDocumentsFiltered(policy, query,
+            [this, &document_predicate](uint32_t document_ordinal) {
+                return document_predicate(document_ids_[document_ordinal], document_statuses_[document_ordinal],
+                                          document_ratings_[document_ordinal]);
+            }, top_k);
     }
 
-    std::vector<Document> FindTopDocuments(const std::string& raw_query, DocumentStatus status) const;
+    template <typename ExecutionPolicy>
+    std::vector<Document> FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query,
+                                      DocumentStatus status,
+                                      size_t top_k = MAX_RESULT_DOCUMENT_COUNT) const {
+        Query query;
+        {
+            SEARCH_TRACE_PHASE(PARSE);
+            query = ParseQuery(raw_query, stop_words_);
+        }
+        return FindTopDocuments(policy, query, status, top_k);
+    }
 
-    std::vector<Document> FindTopDocuments(const std::string& raw_query) const;
+    // Поиск по уже разобранному запросу, например полученному из NormalizeQuery.
+    // Кандидаты отбираются битовой картой статуса, из которой до обхода постингов
+    // вычтены документы с минус-словами: на постинг остаётся проверка одного бита.
+    // Такие документы попадают в счётчик трассировки DOCUMENTS_FILTERED
+    template <typename ExecutionPolicy>
+    std::vector<Document> FindTopDocuments(ExecutionPolicy&& policy, const Query& query,
+                                      DocumentStatus status,
+                                      size_t top_k = MAX_RESULT_DOCUMENT_COUNT) const {
+        const auto status_it = status_to_documents_.find(status);
+        if (status_it == status_to_documents_.end()) {
+            return {};
+        }
+        if (query.minus_words.empty()) {
+            return FindTopDocumentsFiltered(policy, query, MakeBitmapFilter(status_it->second), top_k);
+        }
+        DocumentBitmap candidates = status_it->second;
+        candidates.RemoveAll(CollectExcludedDocuments(query));
+        Query plus_query;
+        plus_query.plus_words = query.plus_words;
+        return FindTopDocumentsFiltered(policy, plus_query, MakeBitmapFilter(candidates), top_k);
+    }
+
+    template <typename ExecutionPolicy>
+    std::vector<Document> FindTopDocuments(ExecutionPolicy&& policy, std::string_view raw_query) const {
+        return FindTopDocuments(policy, raw_query, DocumentStatus::ACTUAL);
+    }
+
+    template <typename DocumentPredicate>
+    std::vector<Document> FindTopDocuments(std::string_view raw_query,
+                                      DocumentPredicate document_predicate,
+                                      size_t top_k = MAX_RESULT_DOCUMENT_COUNT) const {
+        return FindTopDocuments(std::execution::seq, raw_query, document_predicate, top_k);
+    }
+
+    std::vector<Document> FindTopDocuments(std::string_view raw_query, DocumentStatus status,
+                                      size_t top_k = MAX_RESULT_DOCUMENT_COUNT) const;
+
+    std::vector<Document> FindTopDocuments(std::string_view raw_query) const;
+
+    std::vector<Document> FindTopDocuments(const Query& query, DocumentStatus status,
+                                      size_t top_k = MAX_RESULT_DOCUMENT_COUNT) const;
 
     int GetDocumentCount() const;
 
+    // Меняется при каждом добавлении и удалении документа: по нему кэши
+    // результатов понимают, что индекс изменился
+    uint64_t GetGeneration() const;
+
+    // Разбор запроса так, как его видит поиск: без стоп-слов и повторов,
+    // слова отсортированы. Слова ссылаются на текст запроса
+    Query NormalizeQuery(std::string_view raw_query) const;
+
     int GetDocumentId(int index) const;
 
-    std::tuple<std::vector<std::string>, DocumentStatus> MatchDocument(const std::string& raw_query, int document_id) const;
+    // Документы обходятся в порядке их внутренних номеров: по добавлению,
+    // а на место удалённого документа встаёт последний
+    std::vector<int>::const_iterator begin() const;
+
+    std::vector<int>::const_iterator end() const;
+
+    // Частоты слов документа. Индекс хранит термы документа по номерам, и словарь
+    // собирается из них при каждом вызове; для неизвестного id он пуст
+    std::map<std::string_view, double> GetWordFrequencies(int document_id) const;
+
+    // Удаление затрагивает только списки постингов слов самого документа и
+    // последнего документа, который занимает освободившийся номер
+    template <typename ExecutionPolicy>
+    void RemoveDocument(ExecutionPolicy&& policy, int document_id) {
+        const auto ordinal_it = document_ordinals_.find(document_id);
+        if (ordinal_it == document_ordinals_.end()) {
+            return;
+        }
+        const uint32_t document_ordinal = ordinal_it->second;
+        std::vector<PostingList*> postings_to_update = GetDocumentPostings(document_ordinal);
+        std::for_each(policy, postings_to_update.begin(), postings_to_update.end(),
+            [document_ordinal](PostingList* postings) {
+                ErasePosting(*postings, document_ordinal);
+            });
+        status_to_documents_.at(document_statuses_[document_ordinal]).Remove(document_ordinal);
+        document_ordinals_.erase(ordinal_it);
+
+        const auto last_ordinal = static_cast<uint32_t>(document_ids_.size() - 1);
+        if (document_ordinal != last_ordinal) {
+            // Последний документ стоит в конце каждого своего списка постингов,
+            // поэтому его постинг достаточно переставить на новое место
+            postings_to_update = GetDocumentPostings(last_ordinal);
+            std::for_each(policy, postings_to_update.begin(), postings_to_update.end(),
+                [document_ordinal](PostingList* postings) {
+                    MovePostingFromBack(*postings, document_ordinal);
+                });
+            document_ordinals_[document_ids_[last_ordinal]] = document_ordinal;
+            document_ids_[document_ordinal] = document_ids_[last_ordinal];
+            document_ratings_[document_ordinal] = document_ratings_[last_ordinal];
+            DocumentBitmap& status_documents = status_to_documents_.at(document_statuses_[last_ordinal]);
+            status_documents.Remove(last_ordinal);
+            status_documents.Add(document_ordinal);
+            document_statuses_[document_ordinal] = document_statuses_[last_ordinal];
+            document_word_counts_[document_ordinal] = document_word_counts_[last_ordinal];
+            document_terms_[document_ordinal] = std::move(document_terms_[last_ordinal]);
+        }
+        document_ids_.pop_back();
+        document_ratings_.pop_back();
+        document_statuses_.pop_back();
+        document_word_counts_.pop_back();
+        document_terms_.pop_back();
+        ++generation_;
+    }
+
+    void RemoveDocument(int document_id);
+
+    // Сохраняет индекс в бинарный файл, формат описан в index_file.h.
+    // Сжатые постинги занимают в несколько раз меньше места, но частоты
+    // слов в них хранятся с точностью до 1/65535
+    void Save(const std::string& path,
+              index_file::PostingFormat posting_format = index_file::PostingFormat::PLAIN) const;
+
+    // Открывает сохранённый индекс только для чтения, не разбирая файл
+    static MappedSearchServer Open(const std::string& path);
+
+    // Найденные слова ссылаются на строки, которыми владеет индекс
+    std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocument(std::string_view raw_query, int document_id) const;
+
+    std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocument(const std::execution::sequenced_policy&,
+                                                                  std::string_view raw_query, int document_id) const;
+
+    std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocument(const std::execution::parallel_policy&,
+                                                                  std::string_view raw_query, int document_id) const;
 
 private:
-    struct DocumentData {
-        int rating;
-        DocumentStatus status;
+    // Элемент инвертированного индекса: документ и частота слова в нём
+    struct Posting {
+        uint32_t document_ordinal;
+        double term_freq;
     };
-    const std::set<std::string> stop_words_;
-    std::map<std::string, std::map<int, double>> word_to_document_freqs_;
-    std::map<int, DocumentData> documents_;
+    // Постинги слова лежат непрерывно и отсортированы по document_ordinal
+    using PostingList = std::vector<Posting>;
+
+    // Элемент прямого индекса: терм документа и его частота
+    struct TermFreq {
+        uint32_t term_id;
+        double term_freq;
+    };
+    // Термы документа без повторов, отсортированы по term_id
+    using TermFreqs = std::vector<TermFreq>;
+
+    // IDF слова, посчитанный для определённого поколения индекса. Поколение
+    // меняется при каждом изменении набора документов, и устаревшее значение
+    // пересчитывается при первом обращении. Значение для одного поколения
+    // одинаково у всех потоков, поэтому параллельные запросы могут
+    // заполнять кэш одновременно
+    class CachedInverseDocumentFreq {
+    public:
+        CachedInverseDocumentFreq() = default;
+        CachedInverseDocumentFreq(const CachedInverseDocumentFreq& other);
+        CachedInverseDocumentFreq& operator=(const CachedInverseDocumentFreq& other);
+
+        bool TryGet(uint64_t generation, double& value) const;
+        void Set(uint64_t generation, double value) const;
+
+    private:
+        mutable std::atomic<uint64_t> generation_{0};
+        mutable std::atomic<double> value_{0.0};
+    };
+
+    struct WordEntry {
+        PostingList postings;
+        CachedInverseDocumentFreq inverse_document_freq;
+        // Верхняя оценка частоты слова в документах. После удаления документов
+        // может быть завышена, но оценкой остаётся
+        double max_term_freq = 0.0;
+    };
+
+    // Позиция в списке постингов слова запроса при обходе документ за документом
+    struct TermCursor {
+        PostingList::const_iterator current;
+        PostingList::const_iterator end;
+        double inverse_document_freq;
+        // Наибольший вклад слова в релевантность любого документа
+        double max_relevance;
+    };
+
+    // Часть пакета документов, разобранная одним потоком. Слова части
+    // получают собственные номера, которые переводятся в номера термов индекса при слиянии
+    struct PartialIndex {
+        // Слова части по их номерам; ссылаются на тексты документов
+        std::vector<HashedWord> words;
+        std::vector<PostingList> postings;
+        // Термы документов части в номерах части
+        std::vector<TermFreqs> document_terms;
+        std::vector<uint32_t> word_counts;
+        // Номер терма индекса для каждого слова части, заполняется при слиянии
+        std::vector<uint32_t> term_ids;
+        std::exception_ptr error;
+    };
+
+    static const size_t RELEVANCE_BUCKET_COUNT = 128;
+    static const size_t ADD_DOCUMENTS_CHUNK_SIZE = 1024;
+
+    StopWordTable stop_words_;
+    // Каждое слово индекса получает 32-битный номер терма: строка слова лежит
+    // в words_, а списки постингов — в terms_ под тем же номером.
+    // Остальные структуры ссылаются на строки из words_ через string_view
+    std::deque<std::string> words_;
+    std::deque<WordEntry> terms_;
+    std::unordered_map<HashedWord, uint32_t, HashedWordHasher> word_to_term_id_;
+    // Документы внутри индекса нумеруются подряд с нуля, и данные документов
+    // лежат в массивах по этим номерам. Внешний id нужен только на входе и в выдаче
+    std::unordered_map<int, uint32_t> document_ordinals_;
     std::vector<int> document_ids_;
+    std::vector<int> document_ratings_;
+    std::vector<DocumentStatus> document_statuses_;
+    // Документы каждого статуса: запросы с отбором по статусу берут кандидатов отсюда
+    std::map<DocumentStatus, DocumentBitmap> status_to_documents_;
+    // Число слов без стоп-слов: по нему файл индекса хранит числа вхождений вместо частот
+    std::vector<uint32_t> document_word_counts_;
+    // Прямой индекс: термы каждого документа
+    std::vector<TermFreqs> document_terms_;
+    // Растёт при каждом добавлении и удалении документа; 0 не бывает текущим поколением
+    uint64_t generation_ = 0;
+
+    void ValidateNewDocumentIds(const std::vector<NewDocument>& documents) const;
+
+    // Не бросает исключений: ошибка разбора сохраняется в PartialIndex::error
+    PartialIndex BuildPartialIndex(const NewDocument* first, const NewDocument* last, uint32_t first_ordinal) const;
+
+    // Заводит слова части в словаре и заполняет partial_index.term_ids
+    void MergePartialIndex(PartialIndex& partial_index);
 
-    bool IsStopWord(const std::string& word) const;
+    static TermFreqs TranslateTerms(const TermFreqs& document_terms, const std::vector<uint32_t>& term_ids);
 
-    static bool IsValidWord(const std::string& word);
+    // Частоты термов по номерам всех слов документа, включая повторы
+    static TermFreqs CountTermFreqs(std::vector<uint32_t> term_ids);
 
-    std::vector<std::string> SplitIntoWordsNoStop(const std::string& text) const;
+    // Номер терма слова; новое слово заводится с пустым списком постингов
+    uint32_t FindOrAddTerm(const HashedWord& word);
+
+    // Заводит данные документа под следующим номером, кроме частот слов
+    void RegisterDocument(int document_id, DocumentStatus status, const std::vector<int>& ratings,
+                          uint32_t word_count);
+
+    bool IsStopWord(const HashedWord& word) const;
+
+    // Каждое слово хешируется один раз, этот хеш используют и стоп-слова, и словарь
+    std::vector<HashedWord> SplitIntoWordsNoStop(std::string_view text) const;
 
     static int ComputeAverageRating(const std::vector<int>& ratings);
 
-    struct QueryWord {
-        std::string data;
-        bool is_minus;
-        bool is_stop;
-    };
+    double ComputeWordInverseDocumentFreq(const WordEntry& word_entry) const;
+
+    const uint32_t* FindTermId(const HashedWord& word) const;
+
+    const WordEntry* FindWord(const HashedWord& word) const;
+
+    // Номер терма, если слово есть среди термов документа, иначе nullptr
+    const uint32_t* FindDocumentTerm(const TermFreqs& document_terms, const HashedWord& word) const;
+
+    // Внутренний номер документа или nullptr для неизвестного id
+    const uint32_t* FindDocumentOrdinal(int document_id) const;
 
-    QueryWord ParseQueryWord(const std::string& text) const;
+    std::vector<PostingList*> GetDocumentPostings(uint32_t document_ordinal);
 
-    struct Query {
-        std::set<std::string> plus_words;
-        std::set<std::string> minus_words;
+    static void ErasePosting(PostingList& postings, uint32_t document_ordinal);
+
+    // Переставляет последний постинг списка на место, соответствующее новому номеру документа
+    static void MovePostingFromBack(PostingList& postings, uint32_t document_ordinal);
+
+    // Первый постинг из [first, last) с номером документа не меньше document_ordinal
+    static PostingList::const_iterator SeekPosting(PostingList::const_iterator first,
+                                                   PostingList::const_iterator last, uint32_t document_ordinal);
+
+    // Отсортированные номера документов, содержащих хотя бы одно минус-слово
+    std::vector<uint32_t> CollectExcludedDocuments(const Query& query) const;
+
+    // Проверка документов на исключение по возрастанию их номеров: исключённые номера тоже
+    // отсортированы, поэтому проверка сводится к слиянию двух списков
+    class ExclusionCursor {
+    public:
+        explicit ExclusionCursor(const std::vector<uint32_t>& excluded_ordinals);
+
+        // Вызывается с неубывающими document_ordinal
+        bool IsExcluded(uint32_t document_ordinal);
+
+    private:
+        std::vector<uint32_t>::const_iterator current_;
+        std::vector<uint32_t>::const_iterator end_;
     };
 
-    Query ParseQuery(const std::string& text) const;
+    static auto MakeBitmapFilter(const DocumentBitmap& documents) {
+        return [&documents](uint32_t document_ordinal) {
+            return documents.Contains(document_ordinal);
+        };
+    }
 
-    double ComputeWordInverseDocumentFreq(const std::string& word) const;
+    // Фильтр получает только внутренний номер документа: так для отбора
+    // по статусу не нужно обращаться к данным документа
+    template <typename ExecutionPolicy, typename DocumentFilter>
+    std::vector<Document> FindTopDocumentsFiltered(ExecutionPolicy&& policy, const Query& query,
+                                              DocumentFilter document_filter, size_t top_k) const {
+        if constexpr (std::is_same_v<std::decay_t<ExecutionPolicy>, std::execution::sequenced_policy>) {
+            if (query.plus_words.size() > 1) {
+                return FindTopDocumentsPruned(query, document_filter, top_k);
+            }
+        }
+        auto matched_documents = FindAllDocuments(policy, query, document_filter);
+        SEARCH_TRACE_PHASE(SELECT);
+        SelectTopDocuments(matched_documents, top_k);
+        return matched_documents;
+    }
 
-    template <typename DocumentPredicate>
-    std::vector<Document> FindAllDocuments(const Query& query,
-                                      DocumentPredicate document_predicate) const {
-        std::map<int, double> document_to_relevance;
-        for (const std::string& word : query.plus_words) {
-            if (word_to_document_freqs_.count(word) == 0) {
+    // Обход документ за документом с отсечением WAND: документ оценивается, только если
+    // сумма наибольших вкладов слов, которые могут в нём встретиться, позволяет ему
+    // войти в текущие top_k. Остальные документы пропускаются переходом по спискам
+    // постингов без подсчёта релевантности и без вызова фильтра
+    template <typename DocumentFilter>
+    std::vector<Document> FindTopDocumentsPruned(const Query& query, DocumentFilter document_filter,
+                                            size_t top_k) const {
+        if (top_k == 0) {
+            return {};
+        }
+        std::vector<TermCursor> cursors;
+        for (const HashedWord& word : query.plus_words) {
+            const WordEntry* word_entry = FindWord(word);
+            if (word_entry == nullptr) {
                 continue;
             }
-            const double inverse_document_freq = ComputeWordInverseDocumentFreq(word);
-            for (const auto &[document_id, term_freq] : word_to_document_freqs_.at(word)) {
-                const auto& document_data = documents_.at(document_id);
-                if (document_predicate(document_id, document_data.status, document_data.rating)) {
-                    document_to_relevance[document_id] += term_freq * inverse_document_freq;
+            const double inverse_document_freq = ComputeWordInverseDocumentFreq(*word_entry);
+            cursors.push_back({word_entry->postings.begin(), word_entry->postings.end(),
+                               inverse_document_freq, word_entry->max_term_freq * inverse_document_freq});
+        }
+        const std::vector<uint32_t> excluded_ordinals = CollectExcludedDocuments(query);
+        ExclusionCursor exclusion(excluded_ordinals);
+
+        // Наверху кучи наименее релевантный из отобранных документов
+        std::priority_queue<Document, std::vector<Document>, decltype(&IsMoreRelevant)> top_documents(IsMoreRelevant);
+        SEARCH_TRACE_PHASE(TRAVERSE);
+        while (true) {
+            cursors.erase(std::remove_if(cursors.begin(), cursors.end(),
+                [](const TermCursor& cursor) {
+                    return cursor.current == cursor.end;
+                }), cursors.end());
+            if (cursors.empty()) {
+                break;
+            }
+            std::sort(cursors.begin(), cursors.end(),
+                [](const TermCursor& lhs, const TermCursor& rhs) {
+                    return lhs.current->document_ordinal < rhs.current->document_ordinal;
+                });
+
+            // Документ с релевантностью в пределах epsilon от порога ещё может пройти по рейтингу
+            const double threshold = top_documents.size() < top_k
+                ? -std::numeric_limits<double>::infinity()
+                : top_documents.top().relevance - std::numeric_limits<double>::epsilon();
+            double max_relevance = 0.0;
+            size_t pivot = 0;
+            while (pivot < cursors.size()) {
+                max_relevance += cursors[pivot].max_relevance;
+                if (max_relevance >= threshold) {
+                    break;
                 }
+                ++pivot;
+            }
+            if (pivot == cursors.size()) {
+                break;
             }
-        }
 
-        for (const std::string& word : query.minus_words) {
-            if (word_to_document_freqs_.count(word) == 0) {
+            const uint32_t pivot_ordinal = cursors[pivot].current->document_ordinal;
+            if (exclusion.IsExcluded(pivot_ordinal)) {
+                // Документ с минус-словом не оцениваем, а сразу переходим к следующему
+                SEARCH_TRACE_COUNT(DOCUMENTS_EXCLUDED, 1);
+                for (TermCursor& cursor : cursors) {
+                    cursor.current = SeekPosting(cursor.current, cursor.end, pivot_ordinal + 1);
+                }
                 continue;
             }
-            for (const auto &[document_id, _] : word_to_document_freqs_.at(word)) {
-                document_to_relevance.erase(document_id);
+            if (cursors.front().current->document_ordinal != pivot_ordinal) {
+                for (size_t i = 0; i < pivot; ++i) {
+                    cursors[i].current = SeekPosting(cursors[i].current, cursors[i].end, pivot_ordinal);
+                }
+                continue;
+            }
+
+            double relevance = 0.0;
+            for (TermCursor& cursor : cursors) {
+                if (cursor.current->document_ordinal != pivot_ordinal) {
+                    break;
+                }
+                relevance += cursor.current->term_freq * cursor.inverse_document_freq;
+                ++cursor.current;
+                SEARCH_TRACE_COUNT(POSTINGS_SCANNED, 1);
+            }
+            if (!document_filter(pivot_ordinal)) {
+                SEARCH_TRACE_COUNT(DOCUMENTS_FILTERED, 1);
+                continue;
+            }
+            SEARCH_TRACE_COUNT(DOCUMENTS_SCORED, 1);
+            const Document document(document_ids_[pivot_ordinal], relevance, document_ratings_[pivot_ordinal]);
+            if (top_documents.size() < top_k) {
+                top_documents.push(document);
+            } else if (IsMoreRelevant(document, top_documents.top())) {
+                top_documents.pop();
+                top_documents.push(document);
             }
         }
 
-        std::vector<Document> matched_documents;
-        for (const auto &[document_id, relevance] : document_to_relevance) {
-            matched_documents.push_back(
-                {document_id, relevance, documents_.at(document_id).rating});
+        std::vector<Document> matched_documents(top_documents.size());
+        for (auto it = matched_documents.rbegin(); it != matched_documents.rend(); ++it) {
+            *it = top_documents.top();
+            top_documents.pop();
         }
         return matched_documents;
     }
-};
\ No newline at end of file
+
+    template <typename DocumentFilter>
+    std::vector<Document> FindAllDocuments(const std::execution::sequenced_policy&, const Query& query,
+                                      DocumentFilter document_filter) const {
+        // Документы с минус-словами отбрасываются до подсчёта релевантности и вызова фильтра
+        const std::vector<uint32_t> excluded_ordinals = CollectExcludedDocuments(query);
+        ThreadAccumulatorLease accumulator_lease;
+        RelevanceAccumulator& document_to_relevance = accumulator_lease.Get();
+        document_to_relevance.Reset(document_ids_.size());
+        {
+            SEARCH_TRACE_PHASE(TRAVERSE);
+            for (const HashedWord& word : query.plus_words) {
+                const WordEntry* word_entry = FindWord(word);
+                if (word_entry == nullptr) {
+                    continue;
+                }
+                const double inverse_document_freq = ComputeWordInverseDocumentFreq(*word_entry);
+                SEARCH_TRACE_COUNT(POSTINGS_SCANNED, word_entry->postings.size());
+                ExclusionCursor exclusion(excluded_ordinals);
+                for (const auto& [document_ordinal, term_freq] : word_entry->postings) {
+                    if (exclusion.IsExcluded(document_ordinal)) {
+                        SEARCH_TRACE_COUNT(DOCUMENTS_EXCLUDED, 1);
+                        continue;
+                    }
+                    if (document_filter(document_ordinal)) {
+                        document_to_relevance.Add(document_ordinal, term_freq * inverse_document_freq);
+                    } else {
+                        SEARCH_TRACE_COUNT(DOCUMENTS_FILTERED, 1);
+                    }
+                }
+            }
+        }
+        SEARCH_TRACE_COUNT(DOCUMENTS_SCORED, document_to_relevance.GetTouchedCount());
+
+        return BuildMatchedDocuments(document_to_relevance);
+    }
+
+    // Списки постингов плюс-слов обходятся параллельно, релевантность
+    // накапливается в словаре с отдельной блокировкой на каждую корзину
+    template <typename DocumentFilter>
+    std::vector<Document> FindAllDocuments(const std::execution::parallel_policy&, const Query& query,
+                                      DocumentFilter document_filter) const {
+        const std::vector<uint32_t> excluded_ordinals = CollectExcludedDocuments(query);
+        ConcurrentMap<uint32_t, double> document_to_relevance(RELEVANCE_BUCKET_COUNT);
+        {
+            // Счётчики попадают в статистику тех потоков, которые обходили списки
+            SEARCH_TRACE_PHASE(TRAVERSE);
+            std::for_each(std::execution::par, query.plus_words.begin(), query.plus_words.end(),
+                [&](const HashedWord& word) {
+                    const WordEntry* word_entry = FindWord(word);
+                    if (word_entry == nullptr) {
+                        return;
+                    }
+                    const double inverse_document_freq = ComputeWordInverseDocumentFreq(*word_entry);
+                    SEARCH_TRACE_COUNT(POSTINGS_SCANNED, word_entry->postings.size());
+                    ExclusionCursor exclusion(excluded_ordinals);
+                    for (const auto& [document_ordinal, term_freq] : word_entry->postings) {
+                        if (exclusion.IsExcluded(document_ordinal)) {
+                            SEARCH_TRACE_COUNT(DOCUMENTS_EXCLUDED, 1);
+                            continue;
+                        }
+                        if (document_filter(document_ordinal)) {
+                            document_to_relevance[document_ordinal].ref_to_value += term_freq * inverse_document_freq;
+                        } else {
+                            SEARCH_TRACE_COUNT(DOCUMENTS_FILTERED, 1);
+                        }
+                    }
+                });
+        }
+        const auto relevances = document_to_relevance.BuildOrdinaryMap();
+        SEARCH_TRACE_COUNT(DOCUMENTS_SCORED, relevances.size());
+
+        return BuildMatchedDocuments(relevances);
+    }
+
+    // Аккумулятор свой у каждого потока и переиспользуется всеми запросами потока,
+    // поэтому установившийся поток запросов не выделяет под него память. Если
+    // предикат сам выполняет поиск в том же потоке, аккумулятор потока занят
+    // внешним запросом, и вложенный запрос получает собственный
+    class ThreadAccumulatorLease {
+    public:
+        ThreadAccumulatorLease();
+        ~ThreadAccumulatorLease();
+
+        ThreadAccumulatorLease(const ThreadAccumulatorLease&) = delete;
+        ThreadAccumulatorLease& operator=(const ThreadAccumulatorLease&) = delete;
+
+        RelevanceAccumulator& Get();
+
+    private:
+        struct ThreadAccumulator {
+            RelevanceAccumulator accumulator;
+            bool in_use = false;
+        };
+
+        static ThreadAccumulator& GetThreadAccumulator();
+
+        ThreadAccumulator* thread_accumulator_ = nullptr;
+        std::unique_ptr<RelevanceAccumulator> nested_accumulator_;
+    };
+
+    std::vector<Document> BuildMatchedDocuments(const std::map<uint32_t, double>& document_to_relevance) const;
+
+    std::vector<Document> BuildMatchedDocuments(const RelevanceAccumulator& document_to_relevance) const;
+};
+
+// Объявленное по умолчанию перемещение неявно удаляется, если у члена его нет (например, у const-члена)
+static_assert(std::is_move_constructible_v<SearchServer> && std::is_move_assignable_v<SearchServer>);
\ No newline at end of file
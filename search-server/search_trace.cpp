@@ -0,0 +1,137 @@
+#include "search_trace.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace search_trace {
+
+namespace {
+
+// Пишет в статистику только поток-владелец, а читают снимки из любых потоков
+struct ThreadStats {
+    std::array<std::atomic<uint64_t>, COUNTER_COUNT> counters{};
+    std::array<std::atomic<uint64_t>, PHASE_COUNT> phase_total_ns{};
+    std::array<std::array<std::atomic<uint64_t>, DURATION_BUCKET_COUNT>, PHASE_COUNT> phase_histograms{};
+};
+
+void AddToSnapshot(const ThreadStats& thread_stats, Snapshot& snapshot) {
+    for (size_t i = 0; i < COUNTER_COUNT; ++i) {
+        snapshot.counters[i] += thread_stats.counters[i].load(std::memory_order_relaxed);
+    }
+    for (size_t phase = 0; phase < PHASE_COUNT; ++phase) {
+        snapshot.phase_total_ns[phase] += thread_stats.phase_total_ns[phase].load(std::memory_order_relaxed);
+        for (size_t bucket = 0; bucket < DURATION_BUCKET_COUNT; ++bucket) {
+            snapshot.phase_histograms[phase][bucket] +=
+                thread_stats.phase_histograms[phase][bucket].load(std::memory_order_relaxed);
+        }
+    }
+}
+
+struct Registry {
+    std::mutex mutex;
+    // Статистика живых потоков
+    std::vector<const ThreadStats*> thread_stats;
+    // Сумма по завершившимся потокам: их статистика вливается сюда при выходе потока
+    Snapshot retired;
+};
+
+Registry& GetRegistry() {
+    static Registry registry;
+    return registry;
+}
+
+// Регистрирует статистику потока и при его завершении переносит её в общую сумму
+class ThreadStatsHolder {
+public:
+    ThreadStatsHolder() {
+        Registry& registry = GetRegistry();
+        std::lock_guard guard(registry.mutex);
+        registry.thread_stats.push_back(&stats_);
+    }
+
+    ~ThreadStatsHolder() {
+        Registry& registry = GetRegistry();
+        std::lock_guard guard(registry.mutex);
+        AddToSnapshot(stats_, registry.retired);
+        registry.thread_stats.erase(
+            std::find(registry.thread_stats.begin(), registry.thread_stats.end(), &stats_));
+    }
+
+    ThreadStatsHolder(const ThreadStatsHolder&) = delete;
+    ThreadStatsHolder& operator=(const ThreadStatsHolder&) = delete;
+
+    ThreadStats& Get() {
+        return stats_;
+    }
+
+private:
+    ThreadStats stats_;
+};
+
+ThreadStats& GetThreadStats() {
+    thread_local ThreadStatsHolder holder;
+    return holder.Get();
+}
+
+// Писатель у счётчика один, поэтому атомарное сложение не нужно
+void Increase(std::atomic<uint64_t>& counter, uint64_t value) {
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+size_t GetDurationBucket(std::chrono::nanoseconds duration) {
+    size_t bucket = 0;
+    for (auto value = duration.count(); value > 0 && bucket + 1 < DURATION_BUCKET_COUNT; value >>= 1) {
+        ++bucket;
+    }
+    return bucket;
+}
+
+} // namespace
+
+uint64_t Snapshot::Get(Counter counter) const {
+    return counters[static_cast<size_t>(counter)];
+}
+
+void AddCounter(Counter counter, uint64_t value) {
+    Increase(GetThreadStats().counters[static_cast<size_t>(counter)], value);
+}
+
+void RecordPhase(Phase phase, std::chrono::nanoseconds duration) {
+    ThreadStats& thread_stats = GetThreadStats();
+    const auto phase_index = static_cast<size_t>(phase);
+    Increase(thread_stats.phase_total_ns[phase_index], duration.count());
+    Increase(thread_stats.phase_histograms[phase_index][GetDurationBucket(duration)], 1);
+}
+
+Snapshot GetSnapshot() {
+    Registry& registry = GetRegistry();
+    std::lock_guard guard(registry.mutex);
+    Snapshot snapshot = registry.retired;
+    for (const auto& thread_stats : registry.thread_stats) {
+        AddToSnapshot(*thread_stats, snapshot);
+    }
+    return snapshot;
+}
+
+Snapshot GetThreadSnapshot() {
+    Snapshot snapshot;
+    AddToSnapshot(GetThreadStats(), snapshot);
+    return snapshot;
+}
+
+PhaseTimer::PhaseTimer(Phase phase)
+    : phase_(phase)
+    , start_(std::chrono::steady_clock::now()) {
+}
+
+PhaseTimer::~PhaseTimer() {
+    RecordPhase(phase_, std::chrono::steady_clock::now() - start_);
+}
+
+} // namespace search_trace
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// Время фаз поиска и счётчики обхода индекса, собираемые отдельно в каждом
+// потоке. Сбор включается при сборке макросом SEARCH_SERVER_TRACE; без него
+// макросы SEARCH_TRACE_* раскрываются в пустые выражения, а снимки пусты
+namespace search_trace {
+
+enum class Phase {
+    // Разбор запроса
+    PARSE,
+    // Сбор документов с минус-словами
+    EXCLUDE,
+    // Обход списков постингов и подсчёт релевантности
+    TRAVERSE,
+    // Отбор и сортировка лучших документов
+    SELECT,
+};
+const size_t PHASE_COUNT = 4;
+
+enum class Counter {
+    POSTINGS_SCANNED,
+    DOCUMENTS_SCORED,
+    // Отброшены фильтром или предикатом
+    DOCUMENTS_FILTERED,
+    // Отброшены из-за минус-слов
+    DOCUMENTS_EXCLUDED,
+};
+const size_t COUNTER_COUNT = 4;
+
+// Корзина i гистограммы считает фазы короче 2^i нс, последняя — все более долгие
+const size_t DURATION_BUCKET_COUNT = 32;
+
+struct Snapshot {
+    std::array<uint64_t, COUNTER_COUNT> counters{};
+    std::array<uint64_t, PHASE_COUNT> phase_total_ns{};
+    std::array<std::array<uint64_t, DURATION_BUCKET_COUNT>, PHASE_COUNT> phase_histograms{};
+
+    uint64_t Get(Counter counter) const;
+};
+
+void AddCounter(Counter counter, uint64_t value);
+
+void RecordPhase(Phase phase, std::chrono::nanoseconds duration);
+
+// Сумма по всем потокам, включая завершившиеся
+Snapshot GetSnapshot();
+
+// Только текущий поток: разность снимков до и после запроса даёт его счётчики
+Snapshot GetThreadSnapshot();
+
+// Меряет время от создания до конца области видимости
+class PhaseTimer {
+public:
+    explicit PhaseTimer(Phase phase);
+    ~PhaseTimer();
+
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+private:
+    Phase phase_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace search_trace
+
+#ifdef SEARCH_SERVER_TRACE
+#define SEARCH_TRACE_CONCAT_IMPL(lhs, rhs) lhs##rhs
+#define SEARCH_TRACE_CONCAT(lhs, rhs) SEARCH_TRACE_CONCAT_IMPL(lhs, rhs)
+#define SEARCH_TRACE_PHASE(phase) \
+    search_trace::PhaseTimer SEARCH_TRACE_CONCAT(search_trace_timer_, __LINE__)(search_trace::Phase::phase)
+#define SEARCH_TRACE_COUNT(counter, value) search_trace::AddCounter(search_trace::Counter::counter, (value))
+#else
+#define SEARCH_TRACE_PHASE(phase) static_cast<void>(0)
+#define SEARCH_TRACE_COUNT(counter, value) static_cast<void>(0)
+#endif
@@ -0,0 +1,108 @@
+#include "stop_word_table.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+// В среднем в корзину попадает столько слов
+const size_t WORDS_PER_BUCKET = 4;
+// Столько смещений перебирается для корзины, прежде чем таблица увеличивается
+const uint32_t MAX_DISPLACEMENT = 1 << 16;
+
+} // namespace
+
+StopWordTable::StopWordTable(const std::set<std::string, std::less<>>& words)
+    : words_(words.begin(), words.end()) {
+    if (words_.empty()) {
+        return;
+    }
+    // Заполненность не выше половины, размер — степень двойки
+    size_t slot_count = 1;
+    while (slot_count < words_.size() * 2) {
+        slot_count *= 2;
+    }
+    while (!TryBuild(slot_count)) {
+        slot_count *= 2;
+    }
+}
+
+bool StopWordTable::Contains(std::string_view word) const {
+    return !words_.empty() && Contains(HashWord(word));
+}
+
+bool StopWordTable::Contains(const HashedWord& word) const {
+    if (words_.empty()) {
+        return false;
+    }
+    const uint32_t displacement = displacements_[word.hash % displacements_.size()];
+    const uint32_t slot = slots_[GetSlot(word.hash, displacement, slots_.size() - 1)];
+    return slot != 0 && words_[slot - 1] == word.word;
+}
+
+const std::vector<std::string>& StopWordTable::GetWords() const {
+    return words_;
+}
+
+size_t StopWordTable::GetSlot(uint64_t hash, uint32_t displacement, size_t slot_mask) {
+    // Финальное перемешивание splitmix64: соседние смещения дают независимые ячейки
+    uint64_t value = hash ^ (displacement * 0x9E3779B97F4A7C15ULL);
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+    return (value ^ (value >> 31)) & slot_mask;
+}
+
+bool StopWordTable::TryBuild(size_t slot_count) {
+    const size_t bucket_count = (words_.size() + WORDS_PER_BUCKET - 1) / WORDS_PER_BUCKET;
+    std::vector<uint64_t> hashes(words_.size());
+    std::vector<std::vector<uint32_t>> buckets(bucket_count);
+    for (uint32_t i = 0; i < words_.size(); ++i) {
+        hashes[i] = HashWord(words_[i]).hash;
+        buckets[hashes[i] % bucket_count].push_back(i);
+    }
+    // Большие корзины размещаются первыми, пока таблица почти пуста
+    std::vector<uint32_t> bucket_order(bucket_count);
+    std::iota(bucket_order.begin(), bucket_order.end(), 0);
+    std::stable_sort(bucket_order.begin(), bucket_order.end(),
+        [&buckets](uint32_t lhs, uint32_t rhs) {
+            return buckets[lhs].size() > buckets[rhs].size();
+        });
+
+    displacements_.assign(bucket_count, 0);
+    slots_.assign(slot_count, 0);
+    std::vector<size_t> bucket_slots;
+    for (uint32_t bucket : bucket_order) {
+        const auto& word_indexes = buckets[bucket];
+        uint32_t displacement = 0;
+        for (; displacement < MAX_DISPLACEMENT; ++displacement) {
+            bucket_slots.clear();
+            bool fits = true;
+            for (uint32_t word_index : word_indexes) {
+                const size_t slot = GetSlot(hashes[word_index], displacement, slot_count - 1);
+                if (slots_[slot] != 0
+                    || std::find(bucket_slots.begin(), bucket_slots.end(), slot) != bucket_slots.end()) {
+                    fits = false;
+                    break;
+                }
+                bucket_slots.push_back(slot);
+            }
+            if (fits) {
+                break;
+            }
+        }
+        if (displacement == MAX_DISPLACEMENT) {
+            return false;
+        }
+        displacements_[bucket] = displacement;
+        for (size_t i = 0; i < word_indexes.size(); ++i) {
+            slots_[bucket_slots[i]] = word_indexes[i] + 1;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "string_processing.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Неизменяемый набор стоп-слов с идеальной хеш-функцией в духе CHD.
+// Хеш слова считается один раз: по нему выбирается корзина, а смещение корзины,
+// подобранное при построении, переводит хеш в ячейку таблицы без коллизий.
+// Проверка слова — один хеш и не больше одного сравнения строк
+class StopWordTable {
+public:
+    StopWordTable() = default;
+
+    explicit StopWordTable(const std::set<std::string, std::less<>>& words);
+
+    bool Contains(std::string_view word) const;
+
+    // Хеш слова уже посчитан, например при разборе документа
+    bool Contains(const HashedWord& word) const;
+
+    // Стоп-слова по возрастанию
+    const std::vector<std::string>& GetWords() const;
+
+private:
+    std::vector<std::string> words_;
+    // Смещение для каждой корзины
+    std::vector<uint32_t> displacements_;
+    // Номер слова в words_ плюс один; 0 — пустая ячейка
+    std::vector<uint32_t> slots_;
+
+    static size_t GetSlot(uint64_t hash, uint32_t displacement, size_t slot_mask);
+
+    // Пытается разместить слова в таблице из slot_count ячеек
+    bool TryBuild(size_t slot_count);
+};
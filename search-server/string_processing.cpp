@@ -1,24 +1,193 @@
 #include "string_processing.h"
 
-#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+#if defined(__SSE2__)
+
+// Текст просматривается блоками: для блока строятся битовые маски пробелов
+// и управляющих символов, а границы слов ищутся уже по маскам
+const size_t BLOCK_SIZE = 32;
+
+struct BlockMasks {
+    // Бит i отвечает за байт i блока
+    uint32_t spaces = 0;
+    uint32_t controls = 0;
+};
+
+// Байт меньше пробела, если min(b, ' ' - 1) == b: SSE2 и AVX2 умеют
+// только знаковое сравнение байтов, а беззнаковый минимум есть
+BlockMasks GetBlockMasks(const char* block) {
+    BlockMasks masks;
+#if defined(__AVX2__)
+    const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+    masks.spaces = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(' '))));
+    masks.controls = static_cast<uint32_t>(_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(_mm256_min_epu8(bytes, _mm256_set1_epi8(' ' - 1)), bytes)));
+#else
+    for (size_t half = 0; half < 2; ++half) {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + half * 16));
+        const auto spaces = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(' '))));
+        const auto controls = static_cast<uint32_t>(_mm_movemask_epi8(
+            _mm_cmpeq_epi8(_mm_min_epu8(bytes, _mm_set1_epi8(' ' - 1)), bytes)));
+        masks.spaces |= spaces << (half * 16);
+        masks.controls |= controls << (half * 16);
+    }
+#endif
+    return masks;
+}
+
+size_t CountTrailingZeros(uint32_t mask) {
+#if defined(__GNUC__)
+    return __builtin_ctz(mask);
+#else
+    size_t count = 0;
+    for (; (mask & 1) == 0; mask >>= 1) {
+        ++count;
+    }
+    return count;
+#endif
+}
+
+// Блок текста, начиная с block_begin. Хвост короче блока копируется в tail
+// и дополняется пробелами, чтобы не читать за концом текста
+const char* GetBlock(std::string_view text, size_t block_begin, char* tail) {
+    const char* block = text.data() + block_begin;
+    if (text.size() - block_begin >= BLOCK_SIZE) {
+        return block;
+    }
+    std::memset(tail, ' ', BLOCK_SIZE);
+    std::memcpy(tail, block, text.size() - block_begin);
+    return tail;
+}
+
+// Находит слова текста за один проход и возвращает позицию первого
+// управляющего символа или npos
+size_t SplitIntoWords(std::string_view text, std::vector<std::string_view>& words) {
+    size_t first_control = std::string_view::npos;
+    size_t word_begin = 0;
+    bool in_word = false;
+    char tail[BLOCK_SIZE];
+    for (size_t block_begin = 0; block_begin < text.size(); block_begin += BLOCK_SIZE) {
+        const BlockMasks masks = GetBlockMasks(GetBlock(text, block_begin, tail));
+        if (masks.controls != 0 && first_control == std::string_view::npos) {
+            first_control = block_begin + CountTrailingZeros(masks.controls);
+        }
+        // Биты, где пробел сменяется словом или слово пробелом
+        const uint32_t previous_space = in_word ? 0 : 1;
+        uint32_t boundaries = masks.spaces ^ ((masks.spaces << 1) | previous_space);
+        while (boundaries != 0) {
+            const size_t position = block_begin + CountTrailingZeros(boundaries);
+            if (in_word) {
+                words.push_back(text.substr(word_begin, position - word_begin));
+            } else {
+                word_begin = position;
+            }
+            in_word = !in_word;
+            boundaries &= boundaries - 1;
+        }
+    }
+    if (in_word) {
+        words.push_back(text.substr(word_begin));
+    }
+    return first_control;
+}
 
-std::vector<std::string> SplitIntoWords(const std::string& text) {
-    std::vector<std::string> words;
-    std::string word;
-    for (const char c : text) {
+bool HasControlChars(std::string_view text) {
+    char tail[BLOCK_SIZE];
+    for (size_t block_begin = 0; block_begin < text.size(); block_begin += BLOCK_SIZE) {
+        if (GetBlockMasks(GetBlock(text, block_begin, tail)).controls != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+#else
+
+bool IsControlChar(char c) {
+    return static_cast<unsigned char>(c) < ' ';
+}
+
+size_t SplitIntoWords(std::string_view text, std::vector<std::string_view>& words) {
+    size_t first_control = std::string_view::npos;
+    size_t word_begin = 0;
+    bool in_word = false;
+    for (size_t position = 0; position < text.size(); ++position) {
+        const char c = text[position];
         if (c == ' ') {
-            if (!word.empty()) {
-                words.push_back(word);
-                word.clear();
+            if (in_word) {
+                words.push_back(text.substr(word_begin, position - word_begin));
+                in_word = false;
             }
-        } else {
-            word += c;
+            continue;
+        }
+        if (!in_word) {
+            word_begin = position;
+            in_word = true;
+        }
+        if (first_control == std::string_view::npos && IsControlChar(c)) {
+            first_control = position;
         }
     }
-    if (!word.empty()) {
-        words.push_back(word);
+    if (in_word) {
+        words.push_back(text.substr(word_begin));
+    }
+    return first_control;
+}
+
+bool HasControlChars(std::string_view text) {
+    for (char c : text) {
+        if (IsControlChar(c)) {
+            return true;
+        }
     }
+    return false;
+}
+
+#endif
+
+} // namespace
 
+std::vector<std::string_view> SplitIntoWords(std::string_view text) {
+    std::vector<std::string_view> words;
+    SplitIntoWords(text, words);
     return words;
-}
\ No newline at end of file
+}
+
+std::vector<std::string_view> SplitIntoValidWords(std::string_view text) {
+    std::vector<std::string_view> words;
+    const size_t first_control = SplitIntoWords(text, words);
+    if (first_control != std::string_view::npos) {
+        // Управляющий символ не пробел, поэтому он лежит внутри слова
+        size_t word_begin = text.rfind(' ', first_control);
+        word_begin = word_begin == std::string_view::npos ? 0 : word_begin + 1;
+        const auto word = text.substr(word_begin, text.find(' ', first_control) - word_begin);
+        throw std::invalid_argument("Word " + std::string(word) + " is invalid");
+    }
+    return words;
+}
+
+HashedWord HashWord(std::string_view word) {
+    return {word, std::hash<std::string_view>{}(word)};
+}
+
+bool operator==(const HashedWord& lhs, const HashedWord& rhs) {
+    return lhs.hash == rhs.hash && lhs.word == rhs.word;
+}
+
+bool IsValidWord(std::string_view word) {
+    return !HasControlChars(word);
+}
@@ -1,17 +1,45 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <set>
 
-std::vector<std::string> SplitIntoWords(const std::string& text);
+// Слово вместе с хешем. Хеш считается один раз при разборе текста, а таблица
+// стоп-слов и словарь индекса пользуются готовым значением
+struct HashedWord {
+    std::string_view word;
+    uint64_t hash = 0;
+};
+
+HashedWord HashWord(std::string_view word);
+
+bool operator==(const HashedWord& lhs, const HashedWord& rhs);
+
+struct HashedWordHasher {
+    size_t operator()(const HashedWord& word) const {
+        return word.hash;
+    }
+};
+
+// Возвращаемые слова ссылаются на переданный текст
+std::vector<std::string_view> SplitIntoWords(std::string_view text);
+
+// То же, но слова проверяются как в IsValidWord в том же проходе по тексту.
+// Бросает invalid_argument с первым словом, содержащим управляющий символ
+std::vector<std::string_view> SplitIntoValidWords(std::string_view text);
+
+// Слово не должно содержать управляющих символов
+bool IsValidWord(std::string_view word);
 
 template <typename StringContainer>
-std::set<std::string> MakeUniqueNonEmptyStrings(const StringContainer& strings) {
-    std::set<std::string> non_empty_strings;
-    for (const std::string& str : strings) {
+std::set<std::string, std::less<>> MakeUniqueNonEmptyStrings(const StringContainer& strings) {
+    std::set<std::string, std::less<>> non_empty_strings;
+    for (std::string_view str : strings) {
         if (!str.empty()) {
-            non_empty_strings.insert(str);
+            non_empty_strings.emplace(str);
         }
     }
     return non_empty_strings;